@@ -1,8 +1,15 @@
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <ctime>
 
 #include "app.h"
 #include "SDL3_ttf/SDL_ttf.h"
 #include "resource_manager.h"
+#include "profiler.h"
+#include "random.h"
+#include "ui/animation.h"
 #include "ui/elements/button.h"
 #include "ui/elements/dropdown.h"
 
@@ -14,20 +21,21 @@ using ViewStyle = View::ViewStyle;
 using ButtonStyle = Button::ButtonStyle;
 using DropdownStyle = Dropdown::DropdownStyle;
 
-View* build_ui_tree(SDL_Renderer *renderer) {
+View* build_ui_tree(SDL_Renderer *renderer, uint64_t seed, size_t board_size) {
     auto root = new Div(ViewStyle{
         .flexDirection = YGFlexDirectionColumn,
         .alignItems = YGAlignCenter,
         .gapLength = 5
     }, renderer);
 
-    auto game = new Game(renderer);
+    auto game = new Game(renderer, seed, board_size);
 
     auto header = new Div(ViewStyle{
                             .flexDirection = YGFlexDirectionRow,
                             .justify_content = YGJustifySpaceAround,
                             .padding = 6.0f,
-                            .backgroundColor = SDL_Color{225, 238, 243, 255}
+                            .backgroundColor = SDL_Color{225, 238, 243, 255},
+                            .cache_layer = true
                         }, renderer);
     
     auto difficulty_dropdown = new Dropdown(
@@ -56,7 +64,8 @@ View* build_ui_tree(SDL_Renderer *renderer) {
     auto footer = new Div(ViewStyle{
         .flexDirection = YGFlexDirectionRow,
         .justify_content = YGJustifySpaceAround,
-        .backgroundColor = SDL_Color{130, 130, 130, 255}
+        .backgroundColor = SDL_Color{130, 130, 130, 255},
+        .cache_layer = true
     }, renderer);
 
     root->insert_child(header);
@@ -66,16 +75,29 @@ View* build_ui_tree(SDL_Renderer *renderer) {
     return root;
 }
 
-Application::Application(const ApplicationSpecification &spec)
+Application::Application(const ApplicationSpecification &spec) : m_spec(spec)
 {
     SDL_SetAppMetadata("Example Renderer Clear", "1.0", "com.example.renderer-clear");
 
+    if (spec.headless) {
+        // no display needed, events still work through the dummy driver
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+    }
+
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
         std::exit(EXIT_FAILURE);
     }
 
-    if (!SDL_CreateWindowAndRenderer(spec.title, spec.width, spec.height, SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY, &m_window, &m_renderer)) {
+    if (spec.headless) {
+        m_offscreen_surface = SDL_CreateSurface(spec.width, spec.height, SDL_PIXELFORMAT_ARGB8888);
+        m_renderer = m_offscreen_surface ? SDL_CreateSoftwareRenderer(m_offscreen_surface) : nullptr;
+        if (!m_renderer) {
+            SDL_Log("Couldn't create offscreen renderer: %s", SDL_GetError());
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else if (!SDL_CreateWindowAndRenderer(spec.title, spec.width, spec.height, SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY, &m_window, &m_renderer)) {
         SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
         std::exit(EXIT_FAILURE);
     }
@@ -86,34 +108,80 @@ Application::Application(const ApplicationSpecification &spec)
     }
 
     SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
+    if (!spec.headless) {
+        m_vsync = SDL_SetRenderVSync(m_renderer, 1);
+        if (!m_vsync) {
+            SDL_Log("Couldn't enable vsync, pacing frames with a timer: %s", SDL_GetError());
+        }
+    }
 
-    ui_view_controller = new ViewController(m_renderer, build_ui_tree(m_renderer));
+    const uint64_t seed = spec.seed.has_value() ? spec.seed.value() : Random::get_hourly_seed();
+    ui_view_controller = new ViewController(m_renderer, build_ui_tree(m_renderer, seed, spec.board_size));
 }
 
 Application::~Application()
 {
     delete ui_view_controller;
     SDL_DestroyRenderer(m_renderer);
-    SDL_DestroyWindow(m_window);
+    if (m_window) SDL_DestroyWindow(m_window);
+    if (m_offscreen_surface) SDL_DestroySurface(m_offscreen_surface);
     SDL_Quit();
 }
 
 void Application::run()
 {
+    if (m_spec.headless && m_spec.idle_seconds == 0) {
+        run_headless();
+        return;
+    }
+
 #if defined(PLATFORM_WEB)
     emscripten_set_main_loop(loop, 0, 1);
 #else
     constexpr int fps = 60;
-    constexpr uint64_t frame_delay = 1000/fps;
+    constexpr uint64_t frame_delay_ns = SDL_NS_PER_SECOND/fps;
+    // upper bound on an idle sleep, in case something changes without an event
+    constexpr Sint32 idle_wait_timeout = 1000;
+    // --idle-seconds: stop after the window and report what the loop cost
+    const uint64_t end_ticks = SDL_GetTicks() + static_cast<uint64_t>(m_spec.idle_seconds) * 1000;
+    const std::clock_t start_cpu = std::clock();
+    size_t rendered_frames = 0;
     m_running = true;
     while (m_running) {
-        uint64_t frame_start = SDL_GetTicks();
+        if (m_spec.idle_seconds > 0 && SDL_GetTicks() >= end_ticks) {
+            break;
+        }
+        if (!m_window_visible) {
+            // nothing can be seen, block until the window comes back or we are asked to quit
+            wait_for_event(-1);
+            continue;
+        }
+        if (!m_frame_rendered && !ui_view_controller->has_scheduled_updates()) {
+            // the last frame changed nothing, so the next one can only come from an event
+            // or from a live resize settling
+            Sint32 timeout = ui_view_controller->is_live_resizing() ? static_cast<Sint32>(ViewController::resize_settle_delay) : idle_wait_timeout;
+            if (m_spec.idle_seconds > 0) {
+                timeout = static_cast<Sint32>(SDL_min(static_cast<uint64_t>(timeout), end_ticks - SDL_min(end_ticks, SDL_GetTicks())));
+            }
+            wait_for_event(timeout);
+        }
+
+        uint64_t frame_start = SDL_GetTicksNS();
         loop();
-        uint64_t frame_time = SDL_GetTicks() - frame_start;
-        if (frame_time < frame_delay) {
-            SDL_Delay(frame_delay - frame_time);
+        uint64_t frame_time = SDL_GetTicksNS() - frame_start;
+        if (m_frame_rendered) {
+            rendered_frames++;
+        }
+        if (m_frame_rendered && !m_vsync && frame_time < frame_delay_ns) {
+            SDL_DelayNS(frame_delay_ns - frame_time);
         }
     }
+
+    if (m_spec.idle_seconds > 0) {
+        const double cpu_ms = 1000.0 * (std::clock() - start_cpu) / CLOCKS_PER_SEC;
+        std::printf("%u s, %zu rendered, %.1f ms cpu (%.2f%% of one core)\n",
+            m_spec.idle_seconds, rendered_frames, cpu_ms, cpu_ms / (m_spec.idle_seconds * 10.0));
+    }
 #endif
 }
 
@@ -127,46 +195,260 @@ inline void Application::loop()
     }
 #endif
 
+#if defined(CORRAL_PROFILER)
+    profiler.begin_frame();
+    // the overlay shows live numbers, so it keeps frames coming while it is up
+    if (profiler.is_overlay_visible()) {
+        m_needs_redraw = true;
+    }
+#endif
+
     update();
-    render();
+    // nothing changed on screen, keep the last presented frame
+    m_frame_rendered = m_needs_redraw || ui_view_controller->needs_redraw() || m_spec.redraw_every_frame;
+    if (m_frame_rendered) {
+        render();
+        m_needs_redraw = false;
+    }
+
+#if defined(CORRAL_PROFILER)
+    profiler.end_frame();
+#endif
 }
 
 void Application::update()
 {
-    handle_input();
+    {
+        PROFILE_SCOPE(section_input);
+        handle_input();
+    }
     if (m_resized) {
         int w,h;
-        if(!SDL_GetWindowSizeInPixels(m_window, &w, &h)) {
+        if (m_offscreen_surface) {
+            w = m_offscreen_surface->w;
+            h = m_offscreen_surface->h;
+        }
+        else if(!SDL_GetWindowSizeInPixels(m_window, &w, &h)) {
             SDL_Log("Couldn't get window size: %s", SDL_GetError());
             std::exit(EXIT_FAILURE);
         }
         ui_view_controller->resize(w, h);
         m_resized = false;
     }
+    PROFILE_SCOPE(section_update);
+    // running tweens request redraws here, which keeps the loop from going idle
+    animator.tick(m_spec.headless && m_spec.idle_seconds == 0 ? m_virtual_clock_ns : SDL_GetTicksNS());
     ui_view_controller->update();
 }
 
 void Application::render()
 {
-    SDL_SetRenderDrawColor(m_renderer, 255, 255, 255, SDL_ALPHA_OPAQUE_FLOAT);
-    SDL_RenderClear(m_renderer);
-    ui_view_controller->render();
+    {
+        PROFILE_SCOPE(section_render);
+        SDL_SetRenderDrawColor(m_renderer, 255, 255, 255, SDL_ALPHA_OPAQUE_FLOAT);
+        SDL_RenderClear(m_renderer);
+        ui_view_controller->render();
+#if defined(CORRAL_PROFILER)
+        profiler.render_overlay(m_renderer);
+#endif
+    }
+    PROFILE_SCOPE(section_present);
     SDL_RenderPresent(m_renderer);
 }
 
+void Application::handle_window_event(const SDL_Event& event)
+{
+    // pointer, keyboard and touch events are queued for the views, in order
+    ui_view_controller->push_event(event);
+    switch (event.type) {
+        case SDL_EVENT_QUIT:
+            m_running = false;
+            break;
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+        case SDL_EVENT_WINDOW_RESIZED:
+            m_resized = true;
+            m_needs_redraw = true;
+            break;
+        case SDL_EVENT_WINDOW_EXPOSED:
+            // the size didn't change, only the contents need to be presented again
+            m_needs_redraw = true;
+            m_window_visible = true;
+            break;
+        case SDL_EVENT_WINDOW_HIDDEN:
+        case SDL_EVENT_WINDOW_MINIMIZED:
+        case SDL_EVENT_WINDOW_OCCLUDED:
+            m_window_visible = false;
+            break;
+#if defined(CORRAL_PROFILER)
+        case SDL_EVENT_KEY_DOWN:
+            if (event.key.key == SDLK_F3 && !event.key.repeat) {
+                profiler.toggle_overlay();
+                m_needs_redraw = true;
+            }
+            break;
+#endif
+        case SDL_EVENT_WINDOW_SHOWN:
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_MAXIMIZED:
+            m_window_visible = true;
+            m_needs_redraw = true;
+            break;
+    }
+}
+
+void Application::wait_for_event(Sint32 timeout_ms)
+{
+    // the event that woke us up is handled here, the rest of the queue in handle_input
+    SDL_Event event;
+    if (SDL_WaitEventTimeout(&event, timeout_ms)) {
+        handle_window_event(event);
+    }
+}
+
 void Application::handle_input()
 {
     SDL_Event event;
     while(SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_EVENT_QUIT:
-                m_running = false;
-                break;
-            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-            case SDL_EVENT_WINDOW_RESIZED:
-            case SDL_EVENT_WINDOW_EXPOSED:
-                m_resized = true;
-                break;
+        handle_window_event(event);
+    }
+}
+
+bool Application::load_script(std::vector<ScriptCommand>& script)
+{
+    if (!m_spec.script_path) {
+        return true;
+    }
+
+    FILE* file = std::fopen(m_spec.script_path, "r");
+    if (!file) {
+        SDL_Log("Couldn't open script %s", m_spec.script_path);
+        return false;
+    }
+
+    char line[512];
+    size_t line_number = 0;
+    while (std::fgets(line, sizeof(line), file)) {
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+
+        ScriptCommand command = {};
+        char name[32];
+        char path[256];
+        int consumed = 0;
+        if (std::sscanf(line, "%zu %31s%n", &command.frame, name, &consumed) != 2) {
+            SDL_Log("%s:%zu: expected \"<frame> <command>\"", m_spec.script_path, line_number);
+            std::fclose(file);
+            return false;
+        }
+        const char* args = line + consumed;
+
+        bool valid = true;
+        if (std::strcmp(name, "move") == 0) {
+            command.type = ScriptCommand::move;
+            valid = std::sscanf(args, "%f %f", &command.pos.x, &command.pos.y) == 2;
         }
+        else if (std::strcmp(name, "down") == 0) {
+            command.type = ScriptCommand::down;
+        }
+        else if (std::strcmp(name, "up") == 0) {
+            command.type = ScriptCommand::up;
+        }
+        else if (std::strcmp(name, "dump") == 0) {
+            command.type = ScriptCommand::dump;
+            valid = std::sscanf(args, "%255s", path) == 1;
+            if (valid) {
+                command.path = path;
+            }
+        }
+        else if (std::strcmp(name, "checksum") == 0) {
+            command.type = ScriptCommand::checksum;
+        }
+        else {
+            valid = false;
+        }
+
+        if (!valid) {
+            SDL_Log("%s:%zu: bad command", m_spec.script_path, line_number);
+            std::fclose(file);
+            return false;
+        }
+        script.push_back(command);
     }
+    std::fclose(file);
+
+    std::stable_sort(script.begin(), script.end(), [](const ScriptCommand& a, const ScriptCommand& b){ return a.frame < b.frame; });
+    return true;
+}
+
+uint64_t Application::get_frame_checksum()
+{
+    // fnv-1a over the visible pixels, the row padding is skipped
+    SDL_FlushRenderer(m_renderer);
+    uint64_t hash = 14695981039346656037ull;
+    const uint8_t* row = static_cast<const uint8_t*>(m_offscreen_surface->pixels);
+    for (int y = 0; y < m_offscreen_surface->h; y++) {
+        for (int x = 0; x < m_offscreen_surface->w * 4; x++) {
+            hash ^= row[x];
+            hash *= 1099511628211ull;
+        }
+        row += m_offscreen_surface->pitch;
+    }
+    return hash;
+}
+
+void Application::run_headless()
+{
+    std::vector<ScriptCommand> script;
+    if (!load_script(script)) {
+        std::exit(EXIT_FAILURE);
+    }
+
+    SDL_FPoint pointer_pos = {0.0f, 0.0f};
+    bool mouse_down = false;
+    size_t next_command = 0;
+    size_t rendered_frames = 0;
+    uint64_t busy_ns = 0;
+
+    for (size_t frame = 0; frame < m_spec.headless_frames && m_running; frame++) {
+        // input for this frame, dumps and checksums look at the frame after it was drawn
+        for (size_t i = next_command; i < script.size() && script[i].frame == frame; i++) {
+            switch (script[i].type) {
+                case ScriptCommand::move: pointer_pos = script[i].pos; break;
+                case ScriptCommand::down: mouse_down = true; break;
+                case ScriptCommand::up: mouse_down = false; break;
+                default: break;
+            }
+            // one step per command so a click within a single frame isn't lost
+            ui_view_controller->set_scripted_pointer(pointer_pos, mouse_down);
+        }
+
+        const uint64_t frame_start = SDL_GetTicksNS();
+        loop();
+        busy_ns += SDL_GetTicksNS() - frame_start;
+        m_virtual_clock_ns += SDL_NS_PER_SECOND / 60;
+        if (m_frame_rendered) {
+            rendered_frames++;
+        }
+
+        if (m_spec.print_checksums) {
+            std::printf("frame %zu %016llx\n", frame, (unsigned long long)get_frame_checksum());
+        }
+        for (; next_command < script.size() && script[next_command].frame == frame; next_command++) {
+            const ScriptCommand& command = script[next_command];
+            if (command.type == ScriptCommand::checksum) {
+                std::printf("frame %zu %016llx\n", frame, (unsigned long long)get_frame_checksum());
+            }
+            else if (command.type == ScriptCommand::dump) {
+                SDL_FlushRenderer(m_renderer);
+                if (!SDL_SaveBMP(m_offscreen_surface, command.path.c_str())) {
+                    SDL_Log("Couldn't save %s: %s", command.path.c_str(), SDL_GetError());
+                }
+            }
+        }
+    }
+
+    std::printf("%zu frames, %zu rendered, %.3f ms per frame\n",
+        m_spec.headless_frames, rendered_frames, m_spec.headless_frames ? busy_ns / 1e6 / m_spec.headless_frames : 0.0);
 }
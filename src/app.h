@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <optional>
 
 #include "SDL3/SDL.h"
 #include "yoga/Yoga.h"
@@ -12,6 +14,22 @@ struct ApplicationSpecification {
     int width = 1000;
     int height = 1000;
     const char *title = "corral";
+    // puzzles of this hour instead of the current one, makes frames reproducible
+    std::optional<uint64_t> seed;
+
+    // render into an offscreen software surface of width x height instead of a window,
+    // input comes from the script and frames can be checksummed or dumped
+    bool headless = false;
+    size_t headless_frames = 60;
+    const char* script_path = nullptr;
+    bool print_checksums = false;
+    // benchmarks: the first board gets this size instead of 4x4
+    size_t board_size = 0;
+    // render and present every frame even if nothing asked for it, the old behaviour
+    bool redraw_every_frame = false;
+    // run the normal event loop, sleeps included, for this many seconds of wall clock and
+    // print the process cpu time it took. works headless too, without a script
+    uint32_t idle_seconds = 0;
 };
 
 class Application {
@@ -22,11 +40,33 @@ public:
     void run();
 
 private:
+    // one line of a headless script: "<frame> move <x> <y>", "<frame> down", "<frame> up",
+    // "<frame> dump <file.bmp>" or "<frame> checksum"
+    struct ScriptCommand {
+        size_t frame;
+        enum { move, down, up, dump, checksum } type;
+        SDL_FPoint pos;
+        std::string path;
+    };
+
+    ApplicationSpecification m_spec;
     SDL_Window *m_window = nullptr;
     SDL_Renderer *m_renderer = nullptr;
+    SDL_Surface *m_offscreen_surface = nullptr;
 
     bool m_running = true;
     bool m_resized = true;
+    // set by window events that lose the contents of the window
+    bool m_needs_redraw = true;
+    // false while the window is hidden, minimized or occluded
+    bool m_window_visible = true;
+    // whether the last loop presented a frame, if not we sleep until the next event
+    bool m_frame_rendered = true;
+    // present blocks until the next vblank, so the loop needs no pacing of its own
+    bool m_vsync = false;
+    // animations run on this clock in headless runs, it advances one 60 hz frame per loop
+    // so runs are reproducible however long a frame takes
+    uint64_t m_virtual_clock_ns = 0;
 
     ViewController* ui_view_controller;
 
@@ -34,4 +74,9 @@ private:
     void update();
     void render();
     void handle_input();
+    void run_headless();
+    bool load_script(std::vector<ScriptCommand>& script);
+    uint64_t get_frame_checksum();
+    void handle_window_event(const SDL_Event& event);
+    void wait_for_event(Sint32 timeout_ms);
 };
@@ -0,0 +1,163 @@
+#include <array>
+#include <algorithm>
+#include "bag_shape.h"
+#include "random.h"
+
+// bit k of a ring is set if the k-th neighbor is in the bag, going clockwise from the top:
+// N, NE, E, SE, S, SW, W, NW. even bits are the sides and odd bits the corners.
+// a flip is legal if the bag cells around the center form a single run (the bag stays
+// connected and the outside stays connected) and no 2x2 block ends up as a checkerboard,
+// which is the only way the border could touch itself.
+static constexpr std::array<bool, 512> make_flip_table()
+{
+    std::array<bool, 512> table{};
+    for (uint32_t key = 0; key < 512; key++)
+    {
+        const uint32_t ring = key & 0xff;
+        const bool center = key >> 8;
+        auto in_bag = [ring](uint32_t k) { return ((ring >> (k % 8)) & 1) != 0; };
+
+        int runs = 0;
+        for (uint32_t k = 0; k < 8; k++)
+        {
+            if (in_bag(k) && !in_bag(k + 7))
+            {
+                runs++;
+            }
+        }
+
+        bool makes_checkerboard = false;
+        for (uint32_t corner = 1; corner < 8; corner += 2)
+        {
+            if (in_bag(corner) != center && in_bag(corner + 7) == center && in_bag(corner + 1) == center)
+            {
+                makes_checkerboard = true;
+            }
+        }
+
+        table[key] = runs == 1 && !makes_checkerboard;
+    }
+    return table;
+}
+
+static constexpr std::array<bool, 512> flip_table = make_flip_table();
+
+BagShape::BagShape(size_t size) : m_size(size), m_stride(size + 2), m_bag_cell_count(size * size), m_in_bag(m_stride * m_stride, 0)
+{
+    const int32_t stride = static_cast<int32_t>(m_stride);
+    const int32_t ring_offsets[] = {-stride, -stride + 1, 1, stride + 1, stride, stride - 1, -1, -stride - 1};
+    std::copy(std::begin(ring_offsets), std::end(ring_offsets), m_ring_offsets);
+
+    for (CellIndexType i = 0; i < m_size; i++)
+    {
+        for (CellIndexType j = 0; j < m_size; j++)
+        {
+            m_in_bag[index_of({i, j})] = 1;
+        }
+    }
+}
+
+bool BagShape::is_in_bag(CellPosition pos)
+{
+    return m_in_bag[index_of(pos)];
+}
+
+bool BagShape::can_flip(CellPosition pos)
+{
+    return can_flip(index_of(pos));
+}
+
+void BagShape::flip(CellPosition pos)
+{
+    flip(index_of(pos));
+}
+
+bool BagShape::can_flip(size_t index)
+{
+    uint32_t key = static_cast<uint32_t>(m_in_bag[index]) << 8;
+    for (uint32_t k = 0; k < 8; k++)
+    {
+        key |= static_cast<uint32_t>(m_in_bag[index + m_ring_offsets[k]]) << k;
+    }
+    return flip_table[key];
+}
+
+void BagShape::flip(size_t index)
+{
+    m_in_bag[index] ^= 1;
+    if (m_in_bag[index])
+    {
+        m_bag_cell_count++;
+    }
+    else
+    {
+        m_bag_cell_count--;
+    }
+}
+
+size_t BagShape::get_size()
+{
+    return m_size;
+}
+
+size_t BagShape::get_bag_cell_count()
+{
+    return m_bag_cell_count;
+}
+
+void BagShape::carve(size_t num_cells, Random& rand)
+{
+    // removable bag cells, slot maps a cell to its place in the vector (-1 if absent)
+    std::vector<uint32_t> removable;
+    std::vector<int32_t> slot(m_in_bag.size(), -1);
+
+    auto update_cell = [&](size_t index) {
+        const bool is_removable = m_in_bag[index] && can_flip(index);
+        if (is_removable && slot[index] == -1)
+        {
+            slot[index] = static_cast<int32_t>(removable.size());
+            removable.push_back(static_cast<uint32_t>(index));
+        }
+        else if (!is_removable && slot[index] != -1)
+        {
+            const uint32_t last = removable.back();
+            removable[slot[index]] = last;
+            slot[last] = slot[index];
+            removable.pop_back();
+            slot[index] = -1;
+        }
+    };
+
+    for (CellIndexType i = 0; i < m_size; i++)
+    {
+        for (CellIndexType j = 0; j < m_size; j++)
+        {
+            update_cell(index_of({i, j}));
+        }
+    }
+
+    for (size_t n = 0; n < num_cells && !removable.empty(); n++)
+    {
+        const size_t index = removable[rand.get_random_int_between_a_inclusive_b_inclusive(0, removable.size() - 1)];
+        flip(index);
+
+        // only the flipped cell and its ring can change removability,
+        // the margin cells are never in the bag so they never enter the set
+        update_cell(index);
+        for (int32_t offset : m_ring_offsets)
+        {
+            update_cell(index + offset);
+        }
+    }
+}
+
+void BagShape::copy_to(Cells<CellState>& cell_state)
+{
+    for (CellIndexType i = 0; i < m_size; i++)
+    {
+        for (CellIndexType j = 0; j < m_size; j++)
+        {
+            cell_state.at(i, j) = m_in_bag[index_of({i, j})] ? CellState::in_bag : CellState::out_of_bag;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "puzzle.h"
+
+struct Random;
+
+// a hole free, 4-connected bag used by the generators.
+// the legality of a flip only depends on the 8 neighbors of the cell (as long as the
+// bag has no holes and never touches itself at a corner) so it is a table lookup,
+// cells are stored with a one cell wide out of bag margin to skip the bounds checks.
+class BagShape {
+public:
+    BagShape(size_t size);
+
+    bool is_in_bag(CellPosition pos);
+    bool can_flip(CellPosition pos);
+    void flip(CellPosition pos);
+
+    size_t get_size();
+    size_t get_bag_cell_count();
+
+    // removes up to num_cells cells, each one picked uniformly among the currently
+    // removable cells. the removable set is updated locally after every removal
+    void carve(size_t num_cells, Random& rand);
+
+    void copy_to(Cells<CellState>& cell_state);
+
+private:
+    size_t m_size;
+    size_t m_stride;
+    size_t m_bag_cell_count;
+    std::vector<uint8_t> m_in_bag;
+    int32_t m_ring_offsets[8];
+
+    inline size_t index_of(CellPosition pos) {
+        return (pos.i + 1) * m_stride + (pos.j + 1);
+    }
+
+    bool can_flip(size_t index);
+    void flip(size_t index);
+
+    friend class McmcShapeSampler;
+};
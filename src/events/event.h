@@ -15,6 +15,9 @@ public:
         mouse_down,
         mouse_up,
         mouse_move,
+        mouse_wheel,
+        key_down,
+        key_up,
     };
 
     Event(Type type, InputState* input_state);
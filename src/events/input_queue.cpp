@@ -0,0 +1,54 @@
+#include "input_queue.h"
+
+InputQueue::InputQueue()
+{
+    m_events.reserve(64);
+}
+
+void InputQueue::push_pointer_move(SDL_FPoint pos)
+{
+    if (pos.x == m_pointer_pos.x && pos.y == m_pointer_pos.y) {
+        return;
+    }
+    m_pointer_pos = pos;
+
+    // hovering only needs to know where the pointer ended up
+    if (m_buttons == 0 && !m_events.empty() && m_events.back().type == InputEvent::pointer_move) {
+        m_events.back().pos = pos;
+        return;
+    }
+    m_events.push_back({.type = InputEvent::pointer_move, .pos = pos});
+}
+
+void InputQueue::push_pointer_button(SDL_FPoint pos, uint8_t button, bool down)
+{
+    // the press happens where the button went down, not where the last motion left us
+    push_pointer_move(pos);
+
+    const uint32_t mask = SDL_BUTTON_MASK(button);
+    if (((m_buttons & mask) != 0) == down) {
+        return;
+    }
+    m_buttons = down ? m_buttons | mask : m_buttons & ~mask;
+    m_events.push_back({.type = down ? InputEvent::pointer_down : InputEvent::pointer_up, .button = button, .pos = pos});
+}
+
+void InputQueue::push_wheel(SDL_FPoint pos, float delta)
+{
+    push_pointer_move(pos);
+    if (!m_events.empty() && m_events.back().type == InputEvent::wheel) {
+        m_events.back().wheel_delta += delta;
+        return;
+    }
+    m_events.push_back({.type = InputEvent::wheel, .pos = pos, .wheel_delta = delta});
+}
+
+void InputQueue::push_key(SDL_Keycode key, bool down, bool repeat)
+{
+    m_events.push_back({.type = down ? InputEvent::key_down : InputEvent::key_up, .repeat = repeat, .pos = m_pointer_pos, .key = key});
+}
+
+void InputQueue::clear()
+{
+    m_events.clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SDL3/SDL.h"
+
+struct InputEvent {
+    enum Type : uint8_t {
+        pointer_move,
+        pointer_down,
+        pointer_up,
+        wheel,
+        key_down,
+        key_up,
+    } type;
+    uint8_t button;         // SDL_BUTTON_LEFT etc. for pointer_down / pointer_up
+    bool repeat;            // key_down only
+    SDL_FPoint pos;         // render coordinates
+    float wheel_delta;
+    SDL_Keycode key;
+};
+
+// the input of one frame in arrival order. the storage is reused from frame to frame so
+// nothing gets allocated once it has grown to the busiest frame. moves are merged while no
+// button is held, every button transition and the whole path of a drag are kept.
+class InputQueue {
+public:
+    InputQueue();
+
+    void push_pointer_move(SDL_FPoint pos);
+    void push_pointer_button(SDL_FPoint pos, uint8_t button, bool down);
+    void push_wheel(SDL_FPoint pos, float delta);
+    void push_key(SDL_Keycode key, bool down, bool repeat);
+
+    inline const std::vector<InputEvent>& get_events() {
+        return m_events;
+    }
+    void clear();
+
+    // where the queued events leave the pointer
+    inline SDL_FPoint get_pointer_pos() {
+        return m_pointer_pos;
+    }
+    inline bool is_button_down(uint8_t button) {
+        return m_buttons & SDL_BUTTON_MASK(button);
+    }
+
+private:
+    std::vector<InputEvent> m_events;
+    SDL_FPoint m_pointer_pos = {0.0f, 0.0f};
+    uint32_t m_buttons = 0;
+};
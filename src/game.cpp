@@ -5,11 +5,11 @@
 #include "resource_manager.h"
 
 
-Game::Game(SDL_Renderer* renderer) : View(ViewStyle{ .flexDirection = YGFlexDirectionColumn, .alignItems = YGAlignCenter, .flexShrink = 1.0f, .padding = 10.0f }, renderer)
+Game::Game(SDL_Renderer* renderer, uint64_t seed, size_t board_size) : View(ViewStyle{ .flexDirection = YGFlexDirectionColumn, .alignItems = YGAlignCenter, .flexShrink = 1.0f, .padding = 10.0f }, renderer)
 {
-    m_grid4x4 = new Grid{4, renderer};
-    m_grid6x6 = new Grid{6, renderer};
-    m_grid10x10 = new Grid{10, renderer};
+    m_grid4x4 = new Grid{board_size ? board_size : 4, renderer, seed};
+    m_grid6x6 = new Grid{6, renderer, seed};
+    m_grid10x10 = new Grid{10, renderer, seed};
 
     insert_child(m_grid4x4);
     insert_child(m_grid6x6);
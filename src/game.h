@@ -9,7 +9,9 @@
 
 class Game : public View {
 public:
-    Game(SDL_Renderer* renderer);
+    // seed is the hour the first puzzles are generated for, a board_size replaces the
+    // 4x4 board for benchmarks
+    Game(SDL_Renderer* renderer, uint64_t seed, size_t board_size = 0);
     ~Game() override;
 
     void on_render() override;
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include "glyph_atlas.h"
+#include "profiler.h"
+
+// glyphs are packed left to right in shelves at most this wide
+static constexpr int max_atlas_width = 1024;
+// one pixel of transparent gap so linear filtering doesn't bleed between glyphs
+static constexpr int glyph_gap = 1;
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer) : m_renderer(renderer)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    clear();
+}
+
+void GlyphAtlas::clear()
+{
+    for (SDL_Surface* surface : m_pending_surfaces) {
+        if (surface) SDL_DestroySurface(surface);
+    }
+    m_pending_surfaces.clear();
+    m_glyphs.clear();
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+}
+
+size_t GlyphAtlas::add_glyph(TTF_Font* font, uint32_t codepoint)
+{
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(font, codepoint, {255, 255, 255, 255});
+    PROFILE_COUNT(counter_ttf_renders, 1);
+    m_pending_surfaces.push_back(surface);
+    m_glyphs.push_back({});
+    return m_glyphs.size() - 1;
+}
+
+void GlyphAtlas::build()
+{
+    // shelf packing, good enough for the few dozen glyphs we keep
+    int atlas_width = 0;
+    for (SDL_Surface* surface : m_pending_surfaces) {
+        if (surface) atlas_width = std::max(atlas_width, surface->w + glyph_gap);
+    }
+    atlas_width = std::max(atlas_width, std::min(max_atlas_width, atlas_width * static_cast<int>(m_pending_surfaces.size())));
+
+    std::vector<SDL_Rect> placements(m_pending_surfaces.size(), SDL_Rect{0, 0, 0, 0});
+    int x = 0;
+    int y = 0;
+    int shelf_height = 0;
+    for (size_t i = 0; i < m_pending_surfaces.size(); i++) {
+        SDL_Surface* surface = m_pending_surfaces[i];
+        if (!surface) {
+            continue;
+        }
+        if (x + surface->w > atlas_width) {
+            x = 0;
+            y += shelf_height + glyph_gap;
+            shelf_height = 0;
+        }
+        placements[i] = {x, y, surface->w, surface->h};
+        x += surface->w + glyph_gap;
+        shelf_height = std::max(shelf_height, surface->h);
+    }
+    const int atlas_height = y + shelf_height;
+
+    if (atlas_width <= 0 || atlas_height <= 0) {
+        // nothing rendered (e.g. a point size of 0). the glyphs stay as empty entries so
+        // their ids remain valid, append_quad skips them
+        for (SDL_Surface* surface : m_pending_surfaces) {
+            if (surface) SDL_DestroySurface(surface);
+        }
+        m_pending_surfaces.clear();
+        if (m_texture) {
+            SDL_DestroyTexture(m_texture);
+            m_texture = nullptr;
+        }
+        return;
+    }
+
+    SDL_Surface* atlas = SDL_CreateSurface(atlas_width, atlas_height, SDL_PIXELFORMAT_ARGB8888);
+    for (size_t i = 0; i < m_pending_surfaces.size(); i++) {
+        SDL_Surface* surface = m_pending_surfaces[i];
+        if (!surface) {
+            continue;
+        }
+        // copy the coverage as is instead of blending it over the empty atlas
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surface, nullptr, atlas, &placements[i]);
+        SDL_DestroySurface(surface);
+
+        const SDL_Rect& rect = placements[i];
+        m_glyphs[i] = {
+            .src = {
+                static_cast<float>(rect.x) / atlas_width,
+                static_cast<float>(rect.y) / atlas_height,
+                static_cast<float>(rect.w) / atlas_width,
+                static_cast<float>(rect.h) / atlas_height
+            },
+            .w = static_cast<float>(rect.w),
+            .h = static_cast<float>(rect.h)
+        };
+    }
+    m_pending_surfaces.clear();
+
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+    }
+    m_texture = SDL_CreateTextureFromSurface(m_renderer, atlas);
+    PROFILE_COUNT(counter_textures_created, 1);
+    PROFILE_COUNT(counter_bytes_uploaded, atlas->pitch * atlas->h);
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    SDL_DestroySurface(atlas);
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::get_glyph(size_t id)
+{
+    return m_glyphs[id];
+}
+
+SDL_Texture* GlyphAtlas::get_texture()
+{
+    return m_texture;
+}
+
+void GlyphAtlas::append_quad(size_t id, float x, float y, SDL_FColor color, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices, float scale)
+{
+    const Glyph& glyph = m_glyphs[id];
+    if (glyph.w <= 0) {
+        return;
+    }
+
+    const float w = glyph.w * scale;
+    const float h = glyph.h * scale;
+    const int base = static_cast<int>(vertices.size());
+    const SDL_FRect& src = glyph.src;
+    vertices.push_back({{x, y}, color, {src.x, src.y}});
+    vertices.push_back({{x + w, y}, color, {src.x + src.w, src.y}});
+    vertices.push_back({{x + w, y + h}, color, {src.x + src.w, src.y + src.h}});
+    vertices.push_back({{x, y + h}, color, {src.x, src.y + src.h}});
+
+    indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "SDL3/SDL.h"
+#include "SDL3_ttf/SDL_ttf.h"
+
+// a handful of glyphs rasterised once in white and packed into one texture.
+// text is drawn as textured quads tinted with the vertex color so any number of
+// strings in any colors go out in a single SDL_RenderGeometry call.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        SDL_FRect src;  // in texture coordinates (0..1)
+        float w;
+        float h;
+    };
+
+    GlyphAtlas(SDL_Renderer* renderer);
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    // drops every glyph and the texture
+    void clear();
+    // returns the id of the glyph, it can be used once build() was called
+    size_t add_glyph(TTF_Font* font, uint32_t codepoint);
+    // packs the glyphs added so far and uploads them
+    void build();
+
+    const Glyph& get_glyph(size_t id);
+    SDL_Texture* get_texture();
+
+    // appends two triangles drawing the glyph with its top left corner at (x, y),
+    // scale stretches the glyph while the atlas is out of date for the wanted size
+    void append_quad(size_t id, float x, float y, SDL_FColor color, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices, float scale = 1.0f);
+
+private:
+    SDL_Renderer* m_renderer;
+    SDL_Texture* m_texture = nullptr;
+    std::vector<Glyph> m_glyphs;
+    std::vector<SDL_Surface*> m_pending_surfaces;
+};
@@ -1,11 +1,13 @@
-#include <format>
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include "grid.h"
 #include "resource_manager.h"
+#include "random.h"
 #include "yoga/Yoga.h"
+#include "ui/animation.h"
 
-Grid::Grid(size_t size, SDL_Renderer* renderer) : View(ViewStyle{.justify_content = YGJustifyCenter, }, renderer) , m_size(size)
+Grid::Grid(size_t size, SDL_Renderer* renderer, uint64_t seed) : View(ViewStyle{.justify_content = YGJustifyCenter, }, renderer) , m_size(size), m_clue_atlas(renderer)
 {
     // YGNodeStyleSetHeightPercent(m_layout_node, 100);
     // YGNodeStyleSetDisplay(m_layout_node, YGDisplayContents);
@@ -15,7 +17,8 @@ Grid::Grid(size_t size, SDL_Renderer* renderer) : View(ViewStyle{.justify_conten
     // YGNodeStyleSetFlex(m_layout_node, 1.0f);
     YGNodeStyleSetAspectRatio(m_layout_node, 1.0f);
 
-    m_puzzle = Puzzle::generate_puzzle(m_size);
+    m_hourly_seed = seed;
+    m_puzzle = Puzzle::generate_puzzle(m_size, seed, get_generation_mode());
 
     m_solved_label = new Label({ .align_self = YGAlignCenter }, renderer, "Well Done!", 120, {219, 10, 91, 255});
     insert_child(m_solved_label);
@@ -24,34 +27,26 @@ Grid::Grid(size_t size, SDL_Renderer* renderer) : View(ViewStyle{.justify_conten
 
 void Grid::on_resize()
 {
-    m_cell_size = calc_cell_size();
-    m_grid_size = calc_grid_size();
+    m_fit_cell_size = calc_cell_size();
+    set_cell_size();
+    // a bigger view may now reach past the edge of the board
+    set_camera(m_camera_x, m_camera_y);
+    m_clip_rect = m_bounds;
     set_textures();
-    m_solved_label->set_point_size(static_cast<int>(m_bounds.w)/6);
+    // the label is hidden most of the time, no point rasterising it for every step of a drag
+    if (!is_live_resizing()) {
+        m_solved_label->set_point_size(static_cast<int>(m_bounds.w)/6);
+    }
 }
 
 void Grid::on_update()
 {   
-        switch (m_extra_input_state) 
-        {
-            case flipping_in_bag_cells:
-                if (m_puzzle->can_remove_from_bag(m_hovered_cell)) {
-                    m_puzzle->remove_from_bag(m_hovered_cell);
-                    m_hovered_cell_color = SDL_Color{255, 255, 255, 150};
-                    set_bag_border_texture();
-                    set_text_texture();
-                }
-                break;
-            case flipping_out_of_bag_cells:
-                if (m_puzzle->can_put_back_in_bag(m_hovered_cell)) {
-                    m_puzzle->put_back_in_bag(m_hovered_cell);
-                    m_hovered_cell_color = SDL_Color{80, 80, 80, 100};
-                    set_bag_border_texture();
-                    set_text_texture();
-                }
-                break;
-            case idle:
-                break;
+        update_flip_animations();
+
+        // however many cells the events flipped, the border and the clues are redone once
+        if (!m_flipped_cells.empty()) {
+            update_after_flips();
+            request_redraw();
         }
 
         switch (m_hover_state)
@@ -70,17 +65,20 @@ void Grid::on_update()
                         m_extra_input_state = idle;
                     }
                     m_hover_state = hover_stable;
+                    request_redraw();
                 }
                 break;
             case hover_stable:
                 break;
         }
 
-    if (m_puzzle->is_solved()) {
+    // only once, showing the label every frame would keep requesting redraws
+    if (m_enabled && m_puzzle->is_solved()) {
         m_enabled = false;
         m_is_cell_hovered = false;
         m_extra_input_state = idle;
         m_solved_label->show();
+        m_solved_label->fade_in(400.0f);
     }
 }
 
@@ -91,6 +89,17 @@ void Grid::on_enter(InputState* input_state)
 void Grid::on_leave(InputState* input_state)
 {
     m_is_cell_hovered = false;
+    request_redraw();
+}
+
+SDL_FPoint Grid::point_to_board_cells(const SDL_FPoint& point)
+{
+    const float pitch = m_cell_size + m_line_width;
+    // a hair short of the far edge so it still lands in the last visible cell
+    return {
+        SDL_clamp((point.x - m_bounds.x - m_padding + m_camera_x) / pitch, static_cast<float>(m_first_visible_cell.j), m_last_visible_cell.j + 0.999f),
+        SDL_clamp((point.y - m_bounds.y - m_padding + m_camera_y) / pitch, static_cast<float>(m_first_visible_cell.i), m_last_visible_cell.i + 0.999f)
+    };
 }
 
 bool Grid::point_to_cell_pos(const SDL_FPoint& point, CellPosition* pos) {
@@ -102,9 +111,10 @@ bool Grid::point_to_cell_pos(const SDL_FPoint& point, CellPosition* pos) {
     };
     
     if (SDL_PointInRectFloat(&point, &content_rect)) {
+        // anything inside the content rect is within the visible range
         *pos = {
-            static_cast<CellIndexType>(SDL_clamp((point.y - content_rect.y) / (m_cell_size + m_line_width), 0, m_size - 1)),
-            static_cast<CellIndexType>(SDL_clamp((point.x - content_rect.x) / (m_cell_size + m_line_width), 0, m_size - 1))
+            static_cast<CellIndexType>(SDL_clamp((point.y - content_rect.y + m_camera_y) / (m_cell_size + m_line_width), m_first_visible_cell.i, m_last_visible_cell.i)),
+            static_cast<CellIndexType>(SDL_clamp((point.x - content_rect.x + m_camera_x) / (m_cell_size + m_line_width), m_first_visible_cell.j, m_last_visible_cell.j))
         };
         return true;
     }
@@ -127,6 +137,13 @@ void Grid::on_mouse_down(InputState* input_state)
                 m_extra_input_state = flipping_out_of_bag_cells;
             }
         }
+        // flipped right away, a click shorter than a frame still counts
+        if (m_extra_input_state != idle) {
+            flip_cell(m_hovered_cell);
+            m_drag_point = point_to_board_cells(input_state->pointer_pos);
+            m_drag_point_valid = true;
+            m_hover_state = hover_moved;
+        }
     }
 }
 
@@ -137,12 +154,227 @@ void Grid::on_mouse_up(InputState* input_state)
 
 void Grid::on_mouse_move(InputState* input_state)
 {
+    if (input_state->pan_is_down) {
+        const float dx = input_state->pointer_pos.x - input_state->prev_pointer_pos.x;
+        const float dy = input_state->pointer_pos.y - input_state->prev_pointer_pos.y;
+        if (set_camera(m_camera_x - dx, m_camera_y - dy)) {
+            set_visible_geometry();
+        }
+    }
+
+    m_is_cell_hovered = point_to_cell_pos(input_state->pointer_pos, &m_hovered_cell);
+    if (m_is_cell_hovered) {
+        m_hover_state = hover_moved;
+    }
+
+    if (m_extra_input_state != idle) {
+        if (m_drag_point_valid) {
+            // leaving the board flips up to its edge, the drag picks up again where it comes back
+            flip_along_drag(point_to_board_cells(input_state->pointer_pos));
+            m_drag_point_valid = m_is_cell_hovered;
+        }
+        else if (m_is_cell_hovered) {
+            flip_cell(m_hovered_cell);
+            m_drag_point = point_to_board_cells(input_state->pointer_pos);
+            m_drag_point_valid = true;
+        }
+    }
+}
+
+bool Grid::flip_cell(CellPosition pos)
+{
+    if (m_extra_input_state == flipping_in_bag_cells && m_puzzle->can_remove_from_bag(pos)) {
+        m_puzzle->remove_from_bag(pos);
+    }
+    else if (m_extra_input_state == flipping_out_of_bag_cells && m_puzzle->can_put_back_in_bag(pos)) {
+        m_puzzle->put_back_in_bag(pos);
+    }
+    else {
+        if (!m_puzzle->can_remove_from_bag(pos) && !m_puzzle->can_put_back_in_bag(pos)) {
+            m_extra_input_state = idle;
+            return false;
+        }
+        // already flipped the way the drag goes
+        return true;
+    }
+    start_flip_animation(pos);
+    m_flipped_cells.push_back(pos);
+    return true;
+}
+
+// walks the cells the segment from m_drag_point to `to` crosses, in order, stepping over a
+// shared edge each time so diagonal moves don't skip the cells next to a corner
+void Grid::flip_along_drag(SDL_FPoint to)
+{
+    const SDL_FPoint from = m_drag_point;
+    m_drag_point = to;
+
+    CellPosition pos = {static_cast<CellIndexType>(SDL_floorf(from.y)), static_cast<CellIndexType>(SDL_floorf(from.x))};
+    const CellPosition last = {static_cast<CellIndexType>(SDL_floorf(to.y)), static_cast<CellIndexType>(SDL_floorf(to.x))};
+    const float dx = to.x - from.x;
+    const float dy = to.y - from.y;
+    const CellIndexType step_j = dx > 0.0f ? 1 : -1;
+    const CellIndexType step_i = dy > 0.0f ? 1 : -1;
+    // how far along the segment, as a fraction of it, the next column / row edge is
+    float next_x = dx != 0.0f ? ((step_j > 0 ? pos.j + 1 : pos.j) - from.x) / dx : std::numeric_limits<float>::max();
+    float next_y = dy != 0.0f ? ((step_i > 0 ? pos.i + 1 : pos.i) - from.y) / dy : std::numeric_limits<float>::max();
+    const float delta_x = dx != 0.0f ? step_j / dx : std::numeric_limits<float>::max();
+    const float delta_y = dy != 0.0f ? step_i / dy : std::numeric_limits<float>::max();
+
+    // the step count bounds the walk even if rounding takes a wrong turn
+    for (CellIndexType steps = std::abs(last.i - pos.i) + std::abs(last.j - pos.j); steps > 0; steps--) {
+        if (pos.j != last.j && (next_x < next_y || pos.i == last.i)) {
+            pos.j += step_j;
+            next_x += delta_x;
+        }
+        else {
+            pos.i += step_i;
+            next_y += delta_y;
+        }
+        if (!flip_cell(pos)) {
+            return;
+        }
+    }
+}
+
+void Grid::on_mouse_wheel(InputState* input_state)
+{
+    if (!set_zoom(m_zoom * SDL_powf(zoom_step, input_state->wheel_delta), input_state->pointer_pos)) {
+        return;
+    }
+    // the board moved under the pointer
     m_is_cell_hovered = point_to_cell_pos(input_state->pointer_pos, &m_hovered_cell);
     if (m_is_cell_hovered) {
         m_hover_state = hover_moved;
     }
 }
 
+void Grid::set_cell_size()
+{
+    m_cell_size = SDL_floorf(m_fit_cell_size * m_zoom);
+    m_grid_size = calc_grid_size();
+}
+
+bool Grid::set_camera(float x, float y)
+{
+    const float max_x = SDL_max(0.0f, m_grid_size - get_view_w());
+    const float max_y = SDL_max(0.0f, m_grid_size - get_view_h());
+    x = SDL_roundf(SDL_clamp(x, 0.0f, max_x));
+    y = SDL_roundf(SDL_clamp(y, 0.0f, max_y));
+    if (x == m_camera_x && y == m_camera_y) {
+        return false;
+    }
+    m_camera_x = x;
+    m_camera_y = y;
+    return true;
+}
+
+bool Grid::set_zoom(float zoom, SDL_FPoint anchor)
+{
+    if (m_fit_cell_size <= 0 || m_grid_size <= 0) {
+        return false;
+    }
+    const float max_zoom = SDL_max(1.0f, max_zoomed_cell_size / m_fit_cell_size);
+    zoom = SDL_clamp(zoom, 1.0f, max_zoom);
+    if (zoom == m_zoom) {
+        return false;
+    }
+
+    // keep the part of the board under the anchor where it is
+    const float anchor_x = anchor.x - (m_bounds.x + m_padding);
+    const float anchor_y = anchor.y - (m_bounds.y + m_padding);
+    const float u = (anchor_x + m_camera_x) / m_grid_size;
+    const float v = (anchor_y + m_camera_y) / m_grid_size;
+
+    m_zoom = zoom;
+    set_cell_size();
+    set_camera(u * m_grid_size - anchor_x, v * m_grid_size - anchor_y);
+    // a new cell size, the clue atlas and every tile are redone
+    set_textures();
+    request_redraw();
+    return true;
+}
+
+void Grid::set_visible_range()
+{
+    if (m_grid_size <= 0) {
+        m_first_visible_cell = {0, 0};
+        m_last_visible_cell = {-1, -1};
+        return;
+    }
+    const float pitch = m_cell_size + m_line_width;
+    const float last = static_cast<float>(m_size - 1);
+    m_first_visible_cell = {
+        static_cast<CellIndexType>(SDL_clamp(SDL_floorf(m_camera_y / pitch), 0.0f, last)),
+        static_cast<CellIndexType>(SDL_clamp(SDL_floorf(m_camera_x / pitch), 0.0f, last))
+    };
+    m_last_visible_cell = {
+        static_cast<CellIndexType>(SDL_clamp(SDL_floorf((m_camera_y + get_view_h()) / pitch), 0.0f, last)),
+        static_cast<CellIndexType>(SDL_clamp(SDL_floorf((m_camera_x + get_view_w()) / pitch), 0.0f, last))
+    };
+}
+
+void Grid::get_visible_tiles(CellPosition* first_tile, CellPosition* last_tile)
+{
+    // the border reaches out of its tiles by half its thickness
+    const float margin = m_bag_border_thickness/2 + m_line_width;
+    const float extent = get_tile_extent();
+    const float last = static_cast<float>(m_tiles_per_side - 1);
+    auto tile_at = [&](float board_px) {
+        return static_cast<CellIndexType>(SDL_clamp(SDL_floorf(board_px / extent), 0.0f, last));
+    };
+    *first_tile = {tile_at(m_camera_y - margin), tile_at(m_camera_x - margin)};
+    *last_tile = {tile_at(m_camera_y + get_view_h() + margin), tile_at(m_camera_x + get_view_w() + margin)};
+}
+
+void Grid::set_visible_geometry()
+{
+    set_visible_range();
+    set_cell_geometry();
+    set_grid_geometry();
+    set_bag_border_geometry();
+    set_clue_geometry();
+}
+
+void Grid::set_textures()
+{
+    set_tiles();
+    set_clue_textures();
+    if (m_grid_size > 0) {
+        m_puzzle->trace_bag_border_points(m_bag_border_points);
+    }
+    set_visible_geometry();
+}
+
+void Grid::set_tiles()
+{
+    m_tiles.clear();
+    m_tiles_per_side = 0;
+    if (m_grid_size <= 0) {
+        return;
+    }
+
+    m_tiles_per_side = (m_size + tile_cells - 1) / tile_cells;
+    m_tiles.resize(m_tiles_per_side * m_tiles_per_side);
+    auto& targets = m_puzzle->get_targets();
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        const CellPosition pos = targets[i].pos;
+        m_tiles[(pos.i / tile_cells) * m_tiles_per_side + pos.j / tile_cells].targets.push_back(i);
+    }
+}
+
+void Grid::update_after_flips()
+{
+    m_puzzle->trace_bag_border_points(m_bag_border_points);
+    for (const CellPosition& pos : m_flipped_cells) {
+        mark_border_tiles_dirty(pos);
+    }
+    m_flipped_cells.clear();
+    set_bag_border_geometry();
+    update_clue_statuses();
+}
+
 void Grid::fill_cell(CellPosition pos, SDL_Color color)
 {
     SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
@@ -150,6 +382,120 @@ void Grid::fill_cell(CellPosition pos, SDL_Color color)
     SDL_RenderFillRect(m_renderer, &rect);
 }
 
+void Grid::set_cell_color(CellPosition pos, float progress)
+{
+    if (m_cell_vertices.empty()) {
+        return;
+    }
+
+    const SDL_FColor in_bag_color = {1.0f, 1.0f, 1.0f, 1.0f};
+    const SDL_FColor out_of_bag_color = {225/255.0f, 238/255.0f, 243/255.0f, 1.0f};
+    const bool in_bag = m_puzzle->is_in_bag(pos);
+    const SDL_FColor& to = in_bag ? in_bag_color : out_of_bag_color;
+    const SDL_FColor& from = in_bag ? out_of_bag_color : in_bag_color;
+    const SDL_FColor color = {
+        from.r + (to.r - from.r) * progress,
+        from.g + (to.g - from.g) * progress,
+        from.b + (to.b - from.b) * progress,
+        1.0f
+    };
+    if (pos.i < m_first_visible_cell.i || pos.i > m_last_visible_cell.i || pos.j < m_first_visible_cell.j || pos.j > m_last_visible_cell.j) {
+        return;
+    }
+    const size_t visible_cols = m_last_visible_cell.j - m_first_visible_cell.j + 1;
+    SDL_Vertex* vertices = &m_cell_vertices[((pos.i - m_first_visible_cell.i) * visible_cols + pos.j - m_first_visible_cell.j) * 4];
+    for (size_t k = 0; k < 4; k++) {
+        vertices[k].color = color;
+    }
+}
+
+void Grid::start_flip_animation(CellPosition pos)
+{
+    // a cell flipped again while it still fades restarts its own slot, two slots on the
+    // same cell would fight over its color
+    CellFlipAnimation* slot = nullptr;
+    for (auto& animation : m_flip_animations) {
+        if (animation.active && animation.pos == pos) {
+            slot = &animation;
+            break;
+        }
+    }
+    if (!slot) {
+        slot = &m_flip_animations[m_next_flip_animation];
+        m_next_flip_animation = (m_next_flip_animation + 1) % max_flip_animations;
+        if (slot->active) {
+            // the slot is taken by an older flip, let it land on its final color
+            animator.cancel(&slot->progress);
+            set_cell_color(slot->pos);
+        }
+    }
+
+    CellFlipAnimation& animation = *slot;
+    animation.pos = pos;
+    animation.progress = 0.0f;
+    animation.active = true;
+    set_cell_color(pos, 0.0f);
+    animator.animate(this, &animation.progress, 1.0f, 150.0f);
+}
+
+void Grid::update_flip_animations()
+{
+    for (auto& animation : m_flip_animations) {
+        if (animation.active) {
+            set_cell_color(animation.pos, animation.progress);
+            animation.active = animation.progress < 1.0f;
+        }
+    }
+}
+
+void Grid::stop_flip_animations()
+{
+    for (auto& animation : m_flip_animations) {
+        if (animation.active) {
+            animator.cancel(&animation.progress);
+            animation.active = false;
+        }
+    }
+}
+
+void Grid::set_cell_geometry()
+{
+    if (m_grid_size <= 0) {
+        m_cell_vertices.clear();
+        m_cell_indices.clear();
+        return;
+    }
+
+    const size_t visible_rows = m_last_visible_cell.i - m_first_visible_cell.i + 1;
+    const size_t visible_cols = m_last_visible_cell.j - m_first_visible_cell.j + 1;
+    m_cell_vertices.resize(visible_rows * visible_cols * 4);
+    m_cell_indices.resize(visible_rows * visible_cols * 6);
+    for (CellIndexType i = m_first_visible_cell.i; i <= m_last_visible_cell.i; i++)
+    {
+        for (CellIndexType j = m_first_visible_cell.j; j <= m_last_visible_cell.j; j++)
+        {
+            const size_t cell = (i - m_first_visible_cell.i) * visible_cols + j - m_first_visible_cell.j;
+            const SDL_FRect rect = get_frect_for_pos({i, j}, m_bounds.x, m_bounds.y);
+            SDL_Vertex* vertices = &m_cell_vertices[cell * 4];
+            vertices[0].position = {rect.x, rect.y};
+            vertices[1].position = {rect.x + rect.w, rect.y};
+            vertices[2].position = {rect.x + rect.w, rect.y + rect.h};
+            vertices[3].position = {rect.x, rect.y + rect.h};
+
+            const int base = static_cast<int>(cell * 4);
+            int* indices = &m_cell_indices[cell * 6];
+            indices[0] = base;
+            indices[1] = base + 1;
+            indices[2] = base + 2;
+            indices[3] = base;
+            indices[4] = base + 2;
+            indices[5] = base + 3;
+
+            set_cell_color({i, j});
+        }
+    }
+}
+
 inline uint32_t absDifference(uint32_t a, uint32_t b) {
     if (a > b) {
         return a - b;
@@ -174,107 +520,223 @@ uint32_t closest(const std::vector<uint16_t>& values, const uint32_t& value) {
     return min_idx;
 }
 
-void Grid::render_cell_target(CellPosition pos, int32_t target, SDL_Surface* text_surface) 
+size_t Grid::glyph_for_char(char c, bool superscript)
 {
-    int text_size = static_cast<int>(m_cell_size/2);
-    int superscript_text_size = static_cast<int>(m_cell_size/5);
-    SDL_Surface* text = TTF_RenderText_Blended(font_manager.get_font_for_point_size(text_size), std::to_string(target).c_str(), 0, {0,0,0,255});
-    SDL_Rect dst_rect = get_rect_for_pos(pos);
+    switch (c) {
+        case '+': return m_plus_glyph;
+        case '-': return m_minus_glyph;
+        default: return superscript ? m_superscript_digit_glyphs[c - '0'] : m_digit_glyphs[c - '0'];
+    }
+}
 
-    dst_rect.x +=  (m_cell_size - text->w) / 2;
-    dst_rect.y +=  (m_cell_size - text->h) / 2;
-    dst_rect.w = text->w;
-    dst_rect.h = text->h;
-    SDL_BlitSurface(text, nullptr, text_surface, &dst_rect);
+float Grid::get_clue_text_width(const std::string& text, bool superscript)
+{
+    float width = 0.0f;
+    for (char c : text) {
+        width += get_clue_glyph_w(glyph_for_char(c, superscript));
+    }
+    return width;
+}
 
-    const int32_t current_score = m_puzzle->get_num_cells_visible_from(pos) - target;
-    SDL_Surface* superscript = nullptr;
-    if (current_score > 0)
-    {
-        superscript = TTF_RenderText_Blended(font_manager.get_font_for_point_size(superscript_text_size), std::format("+{}", current_score).c_str(), 0, {255, 0, 0, 255});
+void Grid::append_clue_text(const std::string& text, bool superscript, float x, float y, SDL_FColor color, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices)
+{
+    for (char c : text) {
+        const size_t glyph = glyph_for_char(c, superscript);
+        m_clue_atlas.append_quad(glyph, x, y, color, vertices, indices, m_clue_scale);
+        x += get_clue_glyph_w(glyph);
     }
-    else if (current_score < 0)
+}
+
+// in board coordinates, the tile is moved to the screen when it is drawn
+void Grid::render_cell_target(CellPosition pos, int32_t target, int32_t delta, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices) 
+{
+    const std::string number = std::to_string(target);
+    const int number_w = static_cast<int>(get_clue_text_width(number, false));
+    const int number_h = static_cast<int>(get_clue_glyph_h(m_digit_glyphs[0]));
+
+    const plutovg_point_t cell_point = cell_position_to_point(pos);
+    SDL_Rect dst_rect = {
+        static_cast<int>(cell_point.x + m_line_width),
+        static_cast<int>(cell_point.y + m_line_width),
+        static_cast<int>(m_cell_size),
+        static_cast<int>(m_cell_size)
+    };
+    dst_rect.x += (m_cell_size - number_w) / 2;
+    dst_rect.y += (m_cell_size - number_h) / 2;
+    append_clue_text(number, false, dst_rect.x, dst_rect.y, {0.0f, 0.0f, 0.0f, 1.0f}, vertices, indices);
+
+    // the + is its own glyph, the - comes with to_string
+    const std::string status = delta > 0 ? "+" + std::to_string(delta) : std::to_string(delta);
+    const int status_w = delta == 0 ? static_cast<int>(get_clue_glyph_w(m_check_glyph)) : static_cast<int>(get_clue_text_width(status, true));
+    const int status_h = delta == 0 ? static_cast<int>(get_clue_glyph_h(m_check_glyph)) : static_cast<int>(get_clue_glyph_h(m_superscript_digit_glyphs[0]));
+
+    dst_rect.x += number_w + std::min(0, (int)((m_cell_size - number_w)/3 - status_w));
+    dst_rect.y -= status_h/4;
+    if (delta == 0)
     {
-        superscript = TTF_RenderText_Blended(font_manager.get_font_for_point_size(superscript_text_size), std::format("{}", current_score).c_str(), 0, {255, 0, 0, 255});
+        m_clue_atlas.append_quad(m_check_glyph, dst_rect.x, dst_rect.y, {0.0f, 1.0f, 0.0f, 1.0f}, vertices, indices, m_clue_scale);
     }
     else
     {
-        superscript = TTF_RenderGlyph_Blended(font_manager.get_icon_font_for_point_size(superscript_text_size), 0xea10, {0, 255, 0, 255});
+        append_clue_text(status, true, dst_rect.x, dst_rect.y, {1.0f, 0.0f, 0.0f, 1.0f}, vertices, indices);
     }
-    
-    dst_rect.x += dst_rect.w + std::min(0, (int)((m_cell_size - text->w)/3 - (superscript->w)));
-    dst_rect.y -= superscript->h/4;
-    dst_rect.w = superscript->w;
-    dst_rect.h = superscript->h;
-    SDL_BlitSurface(superscript, nullptr, text_surface, &dst_rect);
 }
 
-void Grid::set_text_texture() {
-
-    if (m_grid_size <= 0) {
-        if (m_text_texture) {
-            SDL_DestroyTexture(m_text_texture);
-        }
-        m_text_texture = nullptr;
+void Grid::set_clue_atlas()
+{
+    if (m_cell_size == m_clue_atlas_cell_size) {
+        m_clue_scale = 1.0f;
         return;
     }
+    // stretch the glyphs we have, they get rasterised again once the size settles
+    if (is_live_resizing() && m_clue_atlas_cell_size > 0) {
+        m_clue_scale = m_cell_size / m_clue_atlas_cell_size;
+        return;
+    }
+    m_clue_atlas_cell_size = m_cell_size;
+    m_clue_scale = 1.0f;
+
+    const int text_size = static_cast<int>(m_cell_size/2);
+    const int superscript_text_size = static_cast<int>(m_cell_size/5);
+    TTF_Font* font = font_manager.get_font_for_point_size(text_size);
+    TTF_Font* superscript_font = font_manager.get_font_for_point_size(superscript_text_size);
+
+    m_clue_atlas.clear();
+    for (uint32_t digit = 0; digit < 10; digit++) {
+        m_digit_glyphs[digit] = m_clue_atlas.add_glyph(font, '0' + digit);
+        m_superscript_digit_glyphs[digit] = m_clue_atlas.add_glyph(superscript_font, '0' + digit);
+    }
+    m_plus_glyph = m_clue_atlas.add_glyph(superscript_font, '+');
+    m_minus_glyph = m_clue_atlas.add_glyph(superscript_font, '-');
+    m_check_glyph = m_clue_atlas.add_glyph(font_manager.get_icon_font_for_point_size(superscript_text_size), 0xea10);
+    m_clue_atlas.build();
+}
+
+// appends a tile's geometry moved by offset
+static void append_moved_geometry(const std::vector<SDL_Vertex>& src_vertices, const std::vector<int>& src_indices, SDL_FPoint offset, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices)
+{
+    const int base = static_cast<int>(vertices.size());
+    for (const SDL_Vertex& vertex : src_vertices) {
+        vertices.push_back({{vertex.position.x + offset.x, vertex.position.y + offset.y}, vertex.color, vertex.tex_coord});
+    }
+    for (int index : src_indices) {
+        indices.push_back(base + index);
+    }
+}
 
-    SDL_Surface* text_surface = SDL_CreateSurface(m_bounds.w + 1, m_bounds.h + 1, SDL_PIXELFORMAT_ARGB8888);
+void Grid::set_tile_clue_geometry(GridTile& tile)
+{
+    tile.clue_vertices.clear();
+    tile.clue_indices.clear();
+    tile.clues_dirty = false;
 
-    for (auto &[pos, target] : m_puzzle->get_targets())
+    auto& targets = m_puzzle->get_targets();
+    for (size_t i : tile.targets)
     {
-        render_cell_target(pos, target, text_surface);
+        render_cell_target(targets[i].pos, targets[i].target, m_clue_deltas[i], tile.clue_vertices, tile.clue_indices);
+    }
+}
+
+void Grid::set_clue_geometry()
+{
+    m_clue_vertices.clear();
+    m_clue_indices.clear();
+    if (m_tiles.empty() || m_clue_deltas.empty()) {
+        return;
     }
 
-    if (m_text_texture) {
-        SDL_DestroyTexture(m_text_texture);
+    CellPosition first_tile, last_tile;
+    get_visible_tiles(&first_tile, &last_tile);
+    const SDL_FPoint origin = get_board_origin();
+    for (CellIndexType i = first_tile.i; i <= last_tile.i; i++) {
+        for (CellIndexType j = first_tile.j; j <= last_tile.j; j++) {
+            GridTile& tile = m_tiles[i * m_tiles_per_side + j];
+            if (tile.clues_dirty) {
+                set_tile_clue_geometry(tile);
+            }
+            append_moved_geometry(tile.clue_vertices, tile.clue_indices, origin, m_clue_vertices, m_clue_indices);
+        }
     }
-    m_text_texture = SDL_CreateTextureFromSurface(m_renderer, text_surface);
-    SDL_DestroySurface(text_surface);
 }
 
-void Grid::set_grid_texture() {
+void Grid::set_clue_textures() {
 
     if (m_grid_size <= 0) {
-        if (m_grid_texture) {
-            SDL_DestroyTexture(m_grid_texture);
-        }
-        m_grid_texture = nullptr;
+        m_clue_atlas.clear();
+        m_clue_atlas_cell_size = 0.0f;
+        m_clue_deltas.clear();
+        m_clue_vertices.clear();
+        m_clue_indices.clear();
         return;
     }
 
-    plutovg_surface_t* surface = plutovg_surface_create(m_bounds.w + 1, m_bounds.h + 1);
-    plutovg_canvas_t* canvas = plutovg_canvas_create(surface);
+    // the atlas only depends on the cell size, a new puzzle or a reset keeps it
+    set_clue_atlas();
 
-    float dashes[] = {m_line_width, m_cell_size};
-    plutovg_canvas_set_dash_array(canvas, dashes, 2);
-    plutovg_canvas_set_line_width(canvas, m_grid_size);
-    plutovg_canvas_move_to(canvas, 0, m_grid_size/2);
-    plutovg_canvas_line_to(canvas, m_grid_size, m_grid_size/2);
-    plutovg_canvas_move_to(canvas, m_grid_size/2, 0);
-    plutovg_canvas_line_to(canvas, m_grid_size/2, m_grid_size);
+    auto& targets = m_puzzle->get_targets();
+    m_clue_deltas.resize(targets.size());
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        m_clue_deltas[i] = m_puzzle->get_num_cells_visible_from(targets[i].pos) - targets[i].target;
+    }
+}
+
+void Grid::update_clue_statuses() {
+
+    if (m_clue_deltas.empty()) {
+        return;
+    }
 
-    plutovg_canvas_set_rgb(canvas, 0.2049, 0.2827, 0.3809);
-    plutovg_canvas_translate(canvas, m_padding, m_padding);
-    plutovg_canvas_stroke(canvas);
-    // plutovg_surface_write_to_png(surface, "grid.png");
+    // nothing gets rasterised here, only the tiles of a changed status get new quads
+    bool changed = false;
+    auto& targets = m_puzzle->get_targets();
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        const int32_t delta = m_puzzle->get_num_cells_visible_from(targets[i].pos) - targets[i].target;
+        if (delta != m_clue_deltas[i]) {
+            m_clue_deltas[i] = delta;
+            m_tiles[(targets[i].pos.i / tile_cells) * m_tiles_per_side + targets[i].pos.j / tile_cells].clues_dirty = true;
+            changed = true;
+        }
+    }
+    if (changed) {
+        set_clue_geometry();
+    }
+}
+
+void Grid::set_grid_geometry() {
 
-    SDL_Surface* sdl_surface = SDL_CreateSurfaceFrom(
-        plutovg_surface_get_width(surface), 
-        plutovg_surface_get_height(surface),
-        SDL_PIXELFORMAT_ARGB8888,
-        plutovg_surface_get_data(surface),
-        plutovg_surface_get_stride(surface)
-    );
+    m_grid_line_vertices.clear();
+    m_grid_line_indices.clear();
 
-    if (m_grid_texture) {
-        SDL_DestroyTexture(m_grid_texture);
+    if (m_grid_size <= 0) {
+        return;
     }
-    m_grid_texture = SDL_CreateTextureFromSurface(m_renderer, sdl_surface);
 
-    SDL_DestroySurface(sdl_surface);
-    plutovg_canvas_destroy(canvas);
-    plutovg_surface_destroy(surface);
+    const SDL_FColor color = {0.2049f, 0.2827f, 0.3809f, 1.0f};
+    const SDL_FPoint origin = get_board_origin();
+    const float pitch = m_cell_size + m_line_width;
+
+    auto append_quad = [&](float left, float top, float w, float h) {
+        const int base = static_cast<int>(m_grid_line_vertices.size());
+        m_grid_line_vertices.push_back({{left, top}, color, {0.0f, 0.0f}});
+        m_grid_line_vertices.push_back({{left + w, top}, color, {0.0f, 0.0f}});
+        m_grid_line_vertices.push_back({{left + w, top + h}, color, {0.0f, 0.0f}});
+        m_grid_line_vertices.push_back({{left, top + h}, color, {0.0f, 0.0f}});
+        m_grid_line_indices.insert(m_grid_line_indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    };
+
+    // only the lines around the visible cells
+    const float left = origin.x + m_first_visible_cell.j * pitch;
+    const float top = origin.y + m_first_visible_cell.i * pitch;
+    const float right = origin.x + (m_last_visible_cell.j + 1) * pitch + m_line_width;
+    const float bottom = origin.y + (m_last_visible_cell.i + 1) * pitch + m_line_width;
+    for (CellIndexType k = m_first_visible_cell.j; k <= m_last_visible_cell.j + 1; k++) {
+        append_quad(origin.x + k * pitch, top, m_line_width, bottom - top);
+    }
+    for (CellIndexType k = m_first_visible_cell.i; k <= m_last_visible_cell.i + 1; k++) {
+        append_quad(left, origin.y + k * pitch, right - left, m_line_width);
+    }
 }
 
 plutovg_point_t Grid::cell_position_to_point(const CellPosition &pos)
@@ -285,70 +747,128 @@ plutovg_point_t Grid::cell_position_to_point(const CellPosition &pos)
     };
 }
 
-void Grid::set_bag_border_texture() {
+// number of triangles in the disc drawn at every corner of the bag border
+static constexpr int bag_border_join_segments = 16;
 
-    if (m_grid_size <= 0) {
-        if (m_bag_border_texture) {
-            SDL_DestroyTexture(m_bag_border_texture);
-        }
-        m_bag_border_texture = nullptr;
+void Grid::mark_border_tiles_dirty(CellPosition pos)
+{
+    if (m_tiles.empty()) {
         return;
     }
+    // only the edges of the flipped cell can change, plus the joins at its corners
+    const float margin = m_bag_border_thickness/2 + m_line_width;
+    const plutovg_point_t point = cell_position_to_point(pos);
+    const float extent = get_tile_extent();
+    const float pitch = m_cell_size + m_line_width;
+    const float last = static_cast<float>(m_tiles_per_side - 1);
+    auto tile_at = [&](float board_px) {
+        return static_cast<CellIndexType>(SDL_clamp(SDL_floorf(board_px / extent), 0.0f, last));
+    };
+    for (CellIndexType i = tile_at(point.y - margin); i <= tile_at(point.y + pitch + margin); i++) {
+        for (CellIndexType j = tile_at(point.x - margin); j <= tile_at(point.x + pitch + margin); j++) {
+            m_tiles[i * m_tiles_per_side + j].border_dirty = true;
+        }
+    }
+}
 
-    std::vector<CellPosition> bag_border_points; // for drawing the loop around cells
-    m_puzzle->trace_bag_border_points(bag_border_points);
-
-    plutovg_surface_t* surface = plutovg_surface_create(m_bounds.w + 1, m_bounds.h + 1);
-    plutovg_canvas_t* canvas = plutovg_canvas_create(surface);
+void Grid::set_tile_border_geometry(GridTile& tile, CellPosition tile_pos)
+{
+    tile.border_vertices.clear();
+    tile.border_indices.clear();
+    tile.border_dirty = false;
+
+    const float extent = get_tile_extent();
+    const float tile_left = tile_pos.j * extent;
+    const float tile_top = tile_pos.i * extent;
+    const float tile_right = tile_left + extent;
+    const float tile_bottom = tile_top + extent;
+    const float half_thickness = m_bag_border_thickness/2;
+    const SDL_FColor color = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    SDL_FPoint join_offsets[bag_border_join_segments];
+    for (int s = 0; s < bag_border_join_segments; s++) {
+        const float angle = 2.0f * SDL_PI_F * s / bag_border_join_segments;
+        join_offsets[s] = {SDL_cosf(angle) * half_thickness, SDL_sinf(angle) * half_thickness};
+    }
 
-    const plutovg_point_t starting_point = cell_position_to_point(bag_border_points[0]);
-    plutovg_canvas_move_to(canvas, starting_point.x, starting_point.y);
-    for (auto &pos : bag_border_points) {
+    auto to_point = [&](const CellPosition& pos) {
         const plutovg_point_t point = cell_position_to_point(pos);
-        plutovg_canvas_line_to(canvas, point.x, point.y);
+        return SDL_FPoint{point.x + m_line_width/2, point.y + m_line_width/2};
+    };
+
+    auto append_rect = [&](float left, float top, float right, float bottom) {
+        const int base = static_cast<int>(tile.border_vertices.size());
+        tile.border_vertices.push_back({{left, top}, color, {0.0f, 0.0f}});
+        tile.border_vertices.push_back({{right, top}, color, {0.0f, 0.0f}});
+        tile.border_vertices.push_back({{right, bottom}, color, {0.0f, 0.0f}});
+        tile.border_vertices.push_back({{left, bottom}, color, {0.0f, 0.0f}});
+        tile.border_indices.insert(tile.border_indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    };
+
+    // the contour only runs along the grid lines. a segment goes into every tile it reaches,
+    // cut to the tile along its length, so a neighbour never draws a stale piece of it.
+    // the border is opaque so the overlap of the segments and the joins doesn't show
+    const size_t num_points = m_bag_border_points.size();
+    for (size_t k = 0; k < num_points; k++) {
+        const SDL_FPoint a = to_point(m_bag_border_points[k]);
+        const SDL_FPoint b = to_point(m_bag_border_points[(k + 1) % num_points]);
+
+        if (a.y == b.y && a.x != b.x) {
+            const float left = SDL_max(SDL_min(a.x, b.x), tile_left);
+            const float right = SDL_min(SDL_max(a.x, b.x), tile_right);
+            if (left < right && a.y + half_thickness > tile_top && a.y - half_thickness < tile_bottom) {
+                append_rect(left, a.y - half_thickness, right, a.y + half_thickness);
+            }
+        }
+        else if (a.x == b.x && a.y != b.y) {
+            const float top = SDL_max(SDL_min(a.y, b.y), tile_top);
+            const float bottom = SDL_min(SDL_max(a.y, b.y), tile_bottom);
+            if (top < bottom && a.x + half_thickness > tile_left && a.x - half_thickness < tile_right) {
+                append_rect(a.x - half_thickness, top, a.x + half_thickness, bottom);
+            }
+        }
+
+        // round join
+        if (a.x + half_thickness <= tile_left || a.x - half_thickness >= tile_right || a.y + half_thickness <= tile_top || a.y - half_thickness >= tile_bottom) {
+            continue;
+        }
+        const int center = static_cast<int>(tile.border_vertices.size());
+        tile.border_vertices.push_back({a, color, {0.0f, 0.0f}});
+        for (int s = 0; s < bag_border_join_segments; s++) {
+            tile.border_vertices.push_back({{a.x + join_offsets[s].x, a.y + join_offsets[s].y}, color, {0.0f, 0.0f}});
+            tile.border_indices.insert(tile.border_indices.end(), {center, center + 1 + s, center + 1 + (s + 1) % bag_border_join_segments});
+        }
     }
-    plutovg_canvas_close_path(canvas);
-        
-    plutovg_canvas_set_line_width(canvas, m_bag_border_thickness);
-    plutovg_canvas_set_line_join(canvas, PLUTOVG_LINE_JOIN_ROUND);
-    plutovg_canvas_set_rgb(canvas, 0.0, 0.0, 0.0);
-    plutovg_canvas_translate(canvas, m_padding + m_line_width/2, m_padding + m_line_width/2);
-    plutovg_canvas_stroke(canvas);
+}
+
+void Grid::set_bag_border_geometry() {
 
-    SDL_Surface* sdl_surface = SDL_CreateSurfaceFrom(
-        plutovg_surface_get_width(surface), 
-        plutovg_surface_get_height(surface),
-        SDL_PIXELFORMAT_ARGB8888,
-        plutovg_surface_get_data(surface),
-        plutovg_surface_get_stride(surface)
-    );
+    m_bag_border_vertices.clear();
+    m_bag_border_indices.clear();
 
-    if (m_bag_border_texture) {
-        SDL_DestroyTexture(m_bag_border_texture);
+    if (m_tiles.empty()) {
+        return;
     }
-    m_bag_border_texture = SDL_CreateTextureFromSurface(m_renderer, sdl_surface);
 
-    SDL_DestroySurface(sdl_surface);
-    plutovg_canvas_destroy(canvas);
-    plutovg_surface_destroy(surface);
+    CellPosition first_tile, last_tile;
+    get_visible_tiles(&first_tile, &last_tile);
+    const SDL_FPoint origin = get_board_origin();
+    for (CellIndexType i = first_tile.i; i <= last_tile.i; i++) {
+        for (CellIndexType j = first_tile.j; j <= last_tile.j; j++) {
+            GridTile& tile = m_tiles[i * m_tiles_per_side + j];
+            if (tile.border_dirty) {
+                set_tile_border_geometry(tile, {i, j});
+            }
+            append_moved_geometry(tile.border_vertices, tile.border_indices, origin, m_bag_border_vertices, m_bag_border_indices);
+        }
+    }
 }
 
 void Grid::on_render()
 {
-    for (CellIndexType i = 0; i < m_size; i++)
-    {
-        for (CellIndexType j = 0; j < m_size; j++)
-        {
-            if (m_puzzle->is_in_bag({i, j}))
-            {
-                fill_cell({i, j}, {255,255,255,255});
-            }
-            else
-            {
-                // fill_cell({i, j}, {130,130,130,255});
-                fill_cell({i, j}, {225, 238, 243,255});
-            }
-        }
+    // the whole board background is a single draw, the hovered cell goes on top of it
+    if (!m_cell_indices.empty()) {
+        SDL_RenderGeometry(m_renderer, nullptr, m_cell_vertices.data(), static_cast<int>(m_cell_vertices.size()), m_cell_indices.data(), static_cast<int>(m_cell_indices.size()));
     }
 
     if (m_is_cell_hovered)
@@ -356,9 +876,16 @@ void Grid::on_render()
         fill_cell(m_hovered_cell, m_hovered_cell_color);
     }
     
-    if (m_grid_texture) SDL_RenderTexture(m_renderer, m_grid_texture, nullptr, &m_bounds);
-    if (m_bag_border_texture) SDL_RenderTexture(m_renderer, m_bag_border_texture, nullptr, &m_bounds);
-    if (m_text_texture) SDL_RenderTexture(m_renderer, m_text_texture, nullptr, &m_bounds);
+    if (!m_grid_line_indices.empty()) {
+        SDL_RenderGeometry(m_renderer, nullptr, m_grid_line_vertices.data(), static_cast<int>(m_grid_line_vertices.size()), m_grid_line_indices.data(), static_cast<int>(m_grid_line_indices.size()));
+    }
+    if (!m_bag_border_indices.empty()) {
+        SDL_RenderGeometry(m_renderer, nullptr, m_bag_border_vertices.data(), static_cast<int>(m_bag_border_vertices.size()), m_bag_border_indices.data(), static_cast<int>(m_bag_border_indices.size()));
+    }
+
+    if (!m_clue_indices.empty() && m_clue_atlas.get_texture()) {
+        SDL_RenderGeometry(m_renderer, m_clue_atlas.get_texture(), m_clue_vertices.data(), static_cast<int>(m_clue_vertices.size()), m_clue_indices.data(), static_cast<int>(m_clue_indices.size()));
+    }
 }
 
 size_t Grid::get_size()
@@ -368,16 +895,22 @@ size_t Grid::get_size()
 
 void Grid::new_puzzle()
 {
-    m_puzzle = Puzzle::generate_puzzle(m_size);
+    m_puzzle = Puzzle::generate_puzzle(m_size, Random::get_extra_puzzle_seed(m_hourly_seed, m_extra_puzzles++), get_generation_mode());
+    stop_flip_animations();
+    m_flipped_cells.clear();
     set_textures();
     m_enabled = true;
     m_solved_label->hide();
+    request_redraw();
 }
 
 void Grid::reset_puzzle()
 {
     m_puzzle->restart();
+    stop_flip_animations();
+    m_flipped_cells.clear();
     set_textures();
     m_enabled = true;
     m_solved_label->hide();
+    request_redraw();
 }
@@ -4,7 +4,9 @@
 #include <cstddef>
 #include <vector>
 #include <memory>
+#include <string>
 #include "puzzle.h"
+#include "glyph_atlas.h"
 #include "ui/view.h"
 #include "SDL3/SDL.h"
 #include "plutovg.h"
@@ -14,7 +16,7 @@ class Grid : public View{
 public:
     std::unique_ptr<Puzzle> m_puzzle;
 
-    Grid(size_t size, SDL_Renderer* renderer);
+    Grid(size_t size, SDL_Renderer* renderer, uint64_t seed);
 
     void on_render() override;
     void on_resize() override;
@@ -38,20 +40,106 @@ private:
     } m_hover_state = hover_stable;
 
     size_t m_size;
+    // the hour the first puzzle is for and how many new ones were asked for since
+    uint64_t m_hourly_seed;
+    uint64_t m_extra_puzzles = 0;
+    // edge peeling rescans the whole bag for every removed cell, boards this big would
+    // freeze the ui for seconds. the hourly 4x4 / 6x6 / 10x10 boards keep the edge peeling
+    // puzzles the puzzle cache has
+    static constexpr size_t frontier_min_size = 50;
+    inline GenerationMode get_generation_mode()
+    {
+        return m_size >= frontier_min_size ? GenerationMode::frontier : GenerationMode::edge_peeling;
+    }
+    // the cell size that fits the whole board into the view, m_cell_size is this times the zoom
+    float m_fit_cell_size = 0.0f;
     float m_cell_size;
+    // the size of the whole board, it only fits into the view at a zoom of 1
     float m_grid_size;
     float m_line_width = 1.0;
     float m_bag_border_thickness = 4.0;
     float m_padding = 5.0;
 
-    SDL_Texture* m_grid_texture = nullptr;
-    SDL_Texture* m_bag_border_texture = nullptr;
-    SDL_Texture* m_text_texture = nullptr;
+    // camera, a zoom of 1 fits the whole board. m_camera_x/y is the board pixel at the top
+    // left of the content rect, it stays on whole pixels so cached tiles land on the pixel grid
+    float m_zoom = 1.0f;
+    float m_camera_x = 0.0f;
+    float m_camera_y = 0.0f;
+    static constexpr float max_zoomed_cell_size = 96.0f;
+    static constexpr float zoom_step = 1.15f;
+
+    // inclusive range of the cells that are at least partly on screen, only these get
+    // geometry and only they can be hit
+    CellPosition m_first_visible_cell = {0, 0};
+    CellPosition m_last_visible_cell = {-1, -1};
+
+    // clue and border geometry is cached per tile of tile_cells x tile_cells cells in board
+    // coordinates, panning only moves it to the screen and a flip only redoes the tiles it touched
+    static constexpr size_t tile_cells = 16;
+    struct GridTile {
+        std::vector<size_t> targets;    // indices into the puzzle targets
+        std::vector<SDL_Vertex> clue_vertices;
+        std::vector<int> clue_indices;
+        std::vector<SDL_Vertex> border_vertices;
+        std::vector<int> border_indices;
+        bool clues_dirty = true;
+        bool border_dirty = true;
+    };
+    size_t m_tiles_per_side = 0;
+    std::vector<GridTile> m_tiles;
+
+    // 4 vertices per visible cell, row major, only the colors of a flipped cell get rewritten
+    std::vector<SDL_Vertex> m_cell_vertices;
+    std::vector<int> m_cell_indices;
+
+    // recently flipped cells fade to their new color, a new flip reuses the oldest slot
+    struct CellFlipAnimation {
+        CellPosition pos;
+        float progress = 1.0f;
+        bool active = false;
+    };
+    static constexpr size_t max_flip_animations = 16;
+    CellFlipAnimation m_flip_animations[max_flip_animations];
+    size_t m_next_flip_animation = 0;
+
+    // line quads around the visible cells, they change on resize and when the camera moves
+    std::vector<SDL_Vertex> m_grid_line_vertices;
+    std::vector<int> m_grid_line_indices;
+
+    // the bag border is stroked as geometry: a quad per contour segment and a disc per
+    // corner for the round joins, tessellated per tile. these are the visible tiles moved
+    // to the screen
+    std::vector<CellPosition> m_bag_border_points;
+    std::vector<SDL_Vertex> m_bag_border_vertices;
+    std::vector<int> m_bag_border_indices;
+
+    // clues only use digits, + / - and the check mark, they are drawn from an atlas built
+    // for the current cell size. the quads of the visible tiles are drawn as one batch
+    GlyphAtlas m_clue_atlas;
+    size_t m_digit_glyphs[10];
+    size_t m_superscript_digit_glyphs[10];
+    size_t m_plus_glyph;
+    size_t m_minus_glyph;
+    size_t m_check_glyph;
+    float m_clue_atlas_cell_size = 0.0f;
+    // m_cell_size / m_clue_atlas_cell_size, not 1 while a live resize stretches the old atlas
+    float m_clue_scale = 1.0f;
+    std::vector<int32_t> m_clue_deltas;
+    std::vector<SDL_Vertex> m_clue_vertices;
+    std::vector<int> m_clue_indices;
     
     bool m_is_cell_hovered = false;
     CellPosition m_hovered_cell;
     SDL_Color m_hovered_cell_color;
 
+    // cells flipped by the events since the last update. the border and the clues are
+    // redone once for all of them in on_update
+    std::vector<CellPosition> m_flipped_cells;
+    // where the drag was at its previous event, in cells from the board corner. a move
+    // flips every cell on the segment from here to the pointer
+    SDL_FPoint m_drag_point = {0.0f, 0.0f};
+    bool m_drag_point_valid = false;
+
     Label* m_solved_label;
 
     inline float calc_cell_size() 
@@ -65,50 +153,96 @@ private:
         return SDL_floorf(grid_size);
     }
 
+    inline float get_view_w()
+    {
+        return m_bounds.w - 2 * m_padding;
+    }
+    inline float get_view_h()
+    {
+        return m_bounds.h - 2 * m_padding;
+    }
+
+    // where the top left corner of the board is on screen
+    inline SDL_FPoint get_board_origin()
+    {
+        return {m_bounds.x + m_padding - m_camera_x, m_bounds.y + m_padding - m_camera_y};
+    }
+
+    inline float get_tile_extent()
+    {
+        return tile_cells * (m_cell_size + m_line_width);
+    }
+
     inline SDL_FRect get_frect_for_pos(CellPosition pos, float x_offset = 0, float y_offset = 0)
     {
         const SDL_FRect rect = {
-            .x = pos.j * (m_cell_size + m_line_width) + m_line_width + x_offset + m_padding,
-            .y = pos.i * (m_cell_size + m_line_width) + m_line_width + y_offset + m_padding,
+            .x = pos.j * (m_cell_size + m_line_width) + m_line_width + x_offset + m_padding - m_camera_x,
+            .y = pos.i * (m_cell_size + m_line_width) + m_line_width + y_offset + m_padding - m_camera_y,
             .w = m_cell_size,
             .h = m_cell_size
         }; 
         return rect;
     }
 
-    inline SDL_Rect get_rect_for_pos(CellPosition pos, int x_offset = 0, int y_offset = 0)
-    {
-        const SDL_Rect rect = {
-            .x = static_cast<int>(pos.j * (m_cell_size + m_line_width) + m_line_width + x_offset + m_padding),
-            .y = static_cast<int>(pos.i * (m_cell_size + m_line_width) + m_line_width + y_offset + m_padding),
-            .w = static_cast<int>(m_cell_size),
-            .h = static_cast<int>(m_cell_size)
-        }; 
-        return rect;
-    }
-
     void on_enter(InputState* input_state) override;
     void on_leave(InputState* input_state) override;
     void on_mouse_down(InputState* input_state) override;
     void on_mouse_up(InputState* input_state) override;
     void on_mouse_move(InputState* input_state) override;
+    void on_mouse_wheel(InputState* input_state) override;
 
     void handle_input(CellPosition pos, InputState* input_state);
+    // flips pos in the direction of the drag, returns false if the drag ended on a cell
+    // that can't be flipped either way
+    bool flip_cell(CellPosition pos);
+    void flip_along_drag(SDL_FPoint to);
 
-    void render_cell_target(CellPosition pos, int32_t target, SDL_Surface* text_surface);
+    void render_cell_target(CellPosition pos, int32_t target, int32_t delta, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices);
     void fill_cell(CellPosition pos, SDL_Color color);
-
-    void set_grid_texture();
-    void set_bag_border_texture();
-    void set_text_texture();
-
-    inline void set_textures() 
+    void set_cell_color(CellPosition pos, float progress = 1.0f);
+    void start_flip_animation(CellPosition pos);
+    void update_flip_animations();
+    void stop_flip_animations();
+    void set_cell_geometry();
+
+    size_t glyph_for_char(char c, bool superscript);
+    inline float get_clue_glyph_w(size_t glyph)
+    {
+        return m_clue_atlas.get_glyph(glyph).w * m_clue_scale;
+    }
+    inline float get_clue_glyph_h(size_t glyph)
     {
-        set_grid_texture();
-        set_bag_border_texture();
-        set_text_texture();
+        return m_clue_atlas.get_glyph(glyph).h * m_clue_scale;
     }
+    float get_clue_text_width(const std::string& text, bool superscript);
+    void append_clue_text(const std::string& text, bool superscript, float x, float y, SDL_FColor color, std::vector<SDL_Vertex>& vertices, std::vector<int>& indices);
+
+    void set_clue_atlas();
+    void set_clue_geometry();
+
+    void set_grid_geometry();
+    void set_bag_border_geometry();
+    void set_clue_textures();
+    void update_clue_statuses();
+
+    void set_cell_size();
+    // both return false if the camera didn't move
+    bool set_camera(float x, float y);
+    bool set_zoom(float zoom, SDL_FPoint anchor);
+    void set_visible_range();
+    void get_visible_tiles(CellPosition* first_tile, CellPosition* last_tile);
+    void set_tiles();
+    void set_tile_clue_geometry(GridTile& tile);
+    void set_tile_border_geometry(GridTile& tile, CellPosition tile_pos);
+    void mark_border_tiles_dirty(CellPosition pos);
+    // after the bag changed at m_flipped_cells, redoes the border and the clues that depend on it
+    void update_after_flips();
+
+    void set_visible_geometry();
+    void set_textures();
     
     plutovg_point_t cell_position_to_point(const CellPosition &pos);
     bool point_to_cell_pos(const SDL_FPoint &point, CellPosition *pos);
+    // the point in cells from the board corner, clamped to the visible cells
+    SDL_FPoint point_to_board_cells(const SDL_FPoint &point);
 };
@@ -2,10 +2,20 @@
 
 #include "SDL3/SDL.h"
 
+// the state as of the input event being dispatched. the events of a frame are applied one
+// at a time, so the "this frame" flags are set for the single event that caused them
 struct InputState {
     SDL_FPoint pointer_pos;
     SDL_FPoint prev_pointer_pos;
     bool mouse_is_down = false;
     bool mouse_is_pressed_down_this_frame = false;
     bool mouse_is_released_up_this_frame = false;
+    // right or middle button, used to drag views that pan
+    bool pan_is_down = false;
+    // wheel steps of this event, positive away from the user
+    float wheel_delta = 0.0f;
+    // the key of a key_down / key_up event
+    SDL_Keycode key = 0;
+    bool key_is_down = false;
+    bool key_repeat = false;
 };
\ No newline at end of file
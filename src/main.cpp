@@ -1,7 +1,57 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "app.h"
 
-int main() 
+// usage: corral [--headless WxH] [--frames n] [--script file] [--seed hour] [--checksums] [--board n] [--redraw-every-frame] [--idle-seconds s]
+static bool parse_options(int argc, char** argv, ApplicationSpecification& spec)
 {
-    Application app;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0 && has_value) {
+            spec.headless = true;
+            if (std::sscanf(argv[++i], "%dx%d", &spec.width, &spec.height) != 2 || spec.width <= 0 || spec.height <= 0) {
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--frames") == 0 && has_value) {
+            spec.headless_frames = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--script") == 0 && has_value) {
+            spec.script_path = argv[++i];
+        }
+        else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            spec.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--checksums") == 0) {
+            spec.print_checksums = true;
+        }
+        else if (std::strcmp(arg, "--board") == 0 && has_value) {
+            spec.board_size = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--redraw-every-frame") == 0) {
+            spec.redraw_every_frame = true;
+        }
+        else if (std::strcmp(arg, "--idle-seconds") == 0 && has_value) {
+            spec.idle_seconds = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    ApplicationSpecification spec;
+    if (!parse_options(argc, argv, spec)) {
+        std::fprintf(stderr, "usage: %s [--headless WxH] [--frames n] [--script file] [--seed hour] [--checksums] [--board n] [--redraw-every-frame] [--idle-seconds s]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Application app(spec);
     app.run();
 }
@@ -0,0 +1,187 @@
+#include "profiler.h"
+
+#if defined(CORRAL_PROFILER)
+
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+Profiler profiler;
+
+static const char* section_names[Profiler::section_count] = {
+    "input",
+    "update",
+    "layout",
+    "view update",
+    "view render",
+    "render",
+    "present"
+};
+
+static const char* counter_names[Profiler::counter_count] = {
+    "textures created",
+    "bytes uploaded",
+    "ttf renders",
+    "vector rasters"
+};
+
+Profiler::~Profiler()
+{
+    if (m_log) {
+        std::fclose(m_log);
+    }
+}
+
+void Profiler::begin_frame()
+{
+    m_frame = {};
+    m_view_times.clear();
+    m_frame_start_ns = SDL_GetTicksNS();
+}
+
+void Profiler::end_frame()
+{
+    m_frame.frame_ns = SDL_GetTicksNS() - m_frame_start_ns;
+    m_history[m_history_next] = m_frame;
+    m_history_next = (m_history_next + 1) % history_size;
+    m_last_view_times.swap(m_view_times);
+
+    if (!m_log_opened) {
+        open_log();
+    }
+    if (m_log) {
+        write_record(m_frame);
+    }
+    m_frame_index++;
+}
+
+void Profiler::add_view_time(const char* view_name, Section section, uint64_t ns)
+{
+    add_time(section, ns);
+    ViewTimes& times = m_view_times[view_name];
+    if (section == section_view_update) {
+        times.update_ns += ns;
+    }
+    else {
+        times.render_ns += ns;
+    }
+}
+
+void Profiler::toggle_overlay()
+{
+    m_overlay_visible = !m_overlay_visible;
+}
+
+bool Profiler::is_overlay_visible()
+{
+    return m_overlay_visible;
+}
+
+void Profiler::open_log()
+{
+    m_log_opened = true;
+    const char* path = std::getenv("CORRAL_PROFILE_LOG");
+    if (!path) {
+        return;
+    }
+    m_log = std::fopen(path, "w");
+    if (!m_log) {
+        SDL_Log("Couldn't open profile log %s", path);
+        return;
+    }
+
+    std::fprintf(m_log, "frame,frame_us");
+    for (const char* name : section_names) {
+        std::fprintf(m_log, ",%s_us", name);
+    }
+    for (const char* name : counter_names) {
+        std::fprintf(m_log, ",%s", name);
+    }
+    std::fputc('\n', m_log);
+}
+
+void Profiler::write_record(const FrameRecord& record)
+{
+    std::fprintf(m_log, "%llu,%llu", (unsigned long long)m_frame_index, (unsigned long long)(record.frame_ns / 1000));
+    for (uint64_t ns : record.section_ns) {
+        std::fprintf(m_log, ",%llu", (unsigned long long)(ns / 1000));
+    }
+    for (uint64_t value : record.counters) {
+        std::fprintf(m_log, ",%llu", (unsigned long long)value);
+    }
+    std::fputc('\n', m_log);
+}
+
+// typeid names are mangled on gcc / clang ("4Grid"), good enough once the length is gone
+static const char* readable_type_name(const char* name)
+{
+    while (std::isdigit(static_cast<unsigned char>(*name))) {
+        name++;
+    }
+    return name;
+}
+
+void Profiler::render_overlay(SDL_Renderer* renderer)
+{
+    if (!m_overlay_visible) {
+        return;
+    }
+
+    // average over the history so the numbers are readable
+    FrameRecord average;
+    uint64_t max_frame_ns = 1;
+    for (const FrameRecord& record : m_history) {
+        average.frame_ns += record.frame_ns / history_size;
+        for (size_t s = 0; s < section_count; s++) {
+            average.section_ns[s] += record.section_ns[s] / history_size;
+        }
+        max_frame_ns = std::max(max_frame_ns, record.frame_ns);
+    }
+    const FrameRecord& last = m_history[(m_history_next + history_size - 1) % history_size];
+
+    constexpr float line_height = 10.0f;
+    constexpr float x = 8.0f;
+    float y = 8.0f;
+    const size_t num_lines = 2 + section_count + counter_count + m_last_view_times.size();
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    const SDL_FRect background = {0, 0, 300, num_lines * line_height + 16 + 50};
+    SDL_RenderFillRect(renderer, &background);
+
+    char line[128];
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_snprintf(line, sizeof(line), "frame %.2f ms (avg of %d)", average.frame_ns / 1e6, (int)history_size);
+    SDL_RenderDebugText(renderer, x, y, line);
+    y += line_height;
+    for (size_t s = 0; s < section_count; s++) {
+        SDL_snprintf(line, sizeof(line), "  %-12s %.3f ms", section_names[s], average.section_ns[s] / 1e6);
+        SDL_RenderDebugText(renderer, x, y, line);
+        y += line_height;
+    }
+    for (size_t c = 0; c < counter_count; c++) {
+        SDL_snprintf(line, sizeof(line), "  %-16s %llu", counter_names[c], (unsigned long long)last.counters[c]);
+        SDL_RenderDebugText(renderer, x, y, line);
+        y += line_height;
+    }
+    SDL_RenderDebugText(renderer, x, y, "last frame per view (update / render us)");
+    y += line_height;
+    for (auto& [name, times] : m_last_view_times) {
+        SDL_snprintf(line, sizeof(line), "  %-14s %6llu %6llu", readable_type_name(name), (unsigned long long)(times.update_ns / 1000), (unsigned long long)(times.render_ns / 1000));
+        SDL_RenderDebugText(renderer, x, y, line);
+        y += line_height;
+    }
+
+    // frame time graph, oldest on the left
+    y += 8.0f;
+    constexpr float graph_height = 40.0f;
+    constexpr float bar_width = 2.0f;
+    SDL_SetRenderDrawColor(renderer, 90, 200, 90, 255);
+    for (size_t i = 0; i < history_size; i++) {
+        const FrameRecord& record = m_history[(m_history_next + i) % history_size];
+        const float h = graph_height * record.frame_ns / max_frame_ns;
+        const SDL_FRect bar = {x + i * bar_width, y + graph_height - h, bar_width, h};
+        SDL_RenderFillRect(renderer, &bar);
+    }
+}
+
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+
+// frame profiler: per frame section times and counters, an overlay toggled with F3 and
+// a per frame csv log (set CORRAL_PROFILE_LOG to its path).
+// everything here compiles to nothing unless the build defines CORRAL_PROFILER
+// (cmake -DCORRAL_PROFILER=ON).
+
+#if defined(CORRAL_PROFILER)
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <typeinfo>
+#include <vector>
+#include <unordered_map>
+
+#include "SDL3/SDL.h"
+
+class Profiler {
+public:
+    enum Section : uint32_t {
+        section_input,
+        section_update,         // ViewController::update, includes layout and the views
+        section_layout,
+        section_view_update,
+        section_view_render,
+        section_render,         // everything drawn before the present
+        section_present,
+        section_count
+    };
+
+    enum Counter : uint32_t {
+        counter_textures_created,
+        counter_bytes_uploaded,
+        counter_ttf_renders,
+        counter_vector_rasterisations,
+        counter_count
+    };
+
+    ~Profiler();
+
+    void begin_frame();
+    void end_frame();
+
+    inline void add_time(Section section, uint64_t ns) {
+        m_frame.section_ns[section] += ns;
+    }
+    // view times are also kept per view class
+    void add_view_time(const char* view_name, Section section, uint64_t ns);
+    inline void count(Counter counter, uint64_t n) {
+        m_frame.counters[counter] += n;
+    }
+
+    void toggle_overlay();
+    bool is_overlay_visible();
+    void render_overlay(SDL_Renderer* renderer);
+
+private:
+    struct FrameRecord {
+        uint64_t frame_ns = 0;
+        uint64_t section_ns[section_count] = {};
+        uint64_t counters[counter_count] = {};
+    };
+
+    struct ViewTimes {
+        uint64_t update_ns = 0;
+        uint64_t render_ns = 0;
+    };
+
+    static constexpr size_t history_size = 120;
+
+    FrameRecord m_frame;
+    uint64_t m_frame_start_ns = 0;
+    uint64_t m_frame_index = 0;
+    std::unordered_map<const char*, ViewTimes> m_view_times;
+
+    FrameRecord m_history[history_size];
+    size_t m_history_next = 0;
+    std::unordered_map<const char*, ViewTimes> m_last_view_times;
+
+    bool m_overlay_visible = false;
+    bool m_log_opened = false;
+    FILE* m_log = nullptr;
+
+    void open_log();
+    void write_record(const FrameRecord& record);
+};
+
+extern Profiler profiler;
+
+class ProfileScope {
+public:
+    ProfileScope(Profiler::Section section) : m_section(section), m_start_ns(SDL_GetTicksNS()) {}
+    ~ProfileScope() {
+        profiler.add_time(m_section, SDL_GetTicksNS() - m_start_ns);
+    }
+private:
+    Profiler::Section m_section;
+    uint64_t m_start_ns;
+};
+
+class ProfileViewScope {
+public:
+    ProfileViewScope(Profiler::Section section, const char* view_name) : m_section(section), m_view_name(view_name), m_start_ns(SDL_GetTicksNS()) {}
+    ~ProfileViewScope() {
+        profiler.add_view_time(m_view_name, m_section, SDL_GetTicksNS() - m_start_ns);
+    }
+private:
+    Profiler::Section m_section;
+    const char* m_view_name;
+    uint64_t m_start_ns;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(section) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(Profiler::section)
+#define PROFILE_VIEW_SCOPE(section, view) ProfileViewScope PROFILE_CONCAT(profile_scope_, __LINE__)(Profiler::section, typeid(*(view)).name())
+#define PROFILE_COUNT(counter, n) profiler.count(Profiler::counter, (n))
+
+#else
+
+#define PROFILE_SCOPE(section)
+#define PROFILE_VIEW_SCOPE(section, view)
+#define PROFILE_COUNT(counter, n)
+
+#endif
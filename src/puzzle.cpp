@@ -1,5 +1,8 @@
 #include "puzzle.h"
 #include "random.h"
+#include "bag_shape.h"
+#include "shape_sampler.h"
+#include "visibility.h"
 #include <iterator>
 
 using Move = CellPosition;
@@ -76,7 +79,7 @@ void Puzzle::update_articulation_points()
 
 void Puzzle::update_articulation_points_in_bag(CellPosition root)
 {
-    Cells<size_t> discovery_time(m_cell_state.m_size * m_cell_state.m_size);
+    Cells<size_t> discovery_time(m_cell_state.m_size);
     size_t count = 0;
 
     // check if root has more than one neighbor then it is an articulation point
@@ -147,7 +150,7 @@ size_t Puzzle::recursive_dfs_in_bag(CellPosition node, CellPosition parent_node,
 
 void Puzzle::update_articulation_points_outside_bag()
 {
-    Cells<size_t> discovery_time(m_size * m_size);
+    Cells<size_t> discovery_time(m_size);
     size_t count = 0;
 
     // top
@@ -414,22 +417,65 @@ void Puzzle::trace_bag_border_points(std::vector<CellPosition>& bag_border_point
     } while (true);
 }
 
-std::unique_ptr<Puzzle> Puzzle::generate_puzzle(size_t size)
+std::unique_ptr<Puzzle> Puzzle::generate_puzzle(size_t size, uint64_t seed, GenerationMode mode)
 {
-    static uint64_t seed = Random::get_hourly_seed();
-    Random rand(seed++);
+    Random rand(Random::mix_seed(seed, size));
     auto puzzle = std::make_unique<Puzzle>(size, std::vector<CellTarget>());
     puzzle->m_seed = seed;
     float r = rand.get_random_float_between_a_inclusive_b_inclusive(0, 1);
     size_t num_empty_cells = (size * size) / (2.2 + r);
 
-    Cells<bool> on_edge(size);
+    switch (mode)
+    {
+        case GenerationMode::edge_peeling:
+            puzzle->carve_by_edge_peeling(num_empty_cells, rand);
+            break;
+        case GenerationMode::frontier:
+            {
+                BagShape shape(size);
+                shape.carve(num_empty_cells, rand);
+                shape.copy_to(puzzle->m_cell_state);
+            }
+            break;
+        case GenerationMode::mcmc:
+            {
+                McmcConfig config;
+                config.fill_ratio = 1.0f - static_cast<float>(num_empty_cells) / (size * size);
+                McmcShapeSampler sampler(size, config, rand.rng());
+                sampler.next_shape().copy_to(puzzle->m_cell_state);
+            }
+            break;
+    }
+
+    puzzle->place_targets(rand);
+    puzzle->restart();
+
+    return puzzle;
+}
+
+std::unique_ptr<Puzzle> Puzzle::generate_puzzle_from_shape(BagShape& shape, uint64_t seed)
+{
+    const size_t size = shape.get_size();
+    Random rand(Random::mix_seed(seed, size));
+    auto puzzle = std::make_unique<Puzzle>(size, std::vector<CellTarget>());
+    puzzle->m_seed = seed;
+    shape.copy_to(puzzle->m_cell_state);
+
+    puzzle->place_targets(rand);
+    puzzle->restart();
+
+    return puzzle;
+}
+
+void Puzzle::carve_by_edge_peeling(size_t num_empty_cells, Random& rand)
+{
+    Cells<bool> on_edge(m_size);
     std::vector<CellPosition> edges;
-    for (CellIndexType i = 0; i < size; i++)
+    for (CellIndexType i = 0; i < m_size; i++)
     {
-        for (CellIndexType j = 0; j < size; j++)
+        for (CellIndexType j = 0; j < m_size; j++)
         {
-            if (puzzle->is_on_bag_border({i, j}))
+            if (is_on_bag_border({i, j}))
             {
                 on_edge.at(i, j) = true;
                 edges.push_back({i, j});
@@ -447,18 +493,18 @@ std::unique_ptr<Puzzle> Puzzle::generate_puzzle(size_t size)
         for (size_t i = 0; i < edges.size(); i++)
         {
             
-            if (!puzzle->m_articulation_points[edges[(random_idx + i) % edges.size()]])
+            if (!m_articulation_points[edges[(random_idx + i) % edges.size()]])
             {
                 random_idx = (random_idx + i) % edges.size();
                 break;
             }
             if (i == edges.size() - 1)
             { // reached end without finding an elemnt
-                goto calc_targets_label;
+                return;
             }
         }
         CellPosition random_edge = edges[random_idx];
-        puzzle->remove_from_bag(random_edge);
+        remove_from_bag(random_edge);
         std::swap(edges.back(), edges[random_idx]);
         edges.pop_back();
         on_edge[random_edge] = false;
@@ -467,9 +513,9 @@ std::unique_ptr<Puzzle> Puzzle::generate_puzzle(size_t size)
         for (auto &move : neighbor_moves)
         {
             CellPosition neighbor = random_edge + move;
-            if (puzzle->m_cell_state.is_legal_position(neighbor))
+            if (m_cell_state.is_legal_position(neighbor))
             {
-                if (!on_edge.at(neighbor.i, neighbor.j) && puzzle->is_on_bag_border(neighbor))
+                if (!on_edge.at(neighbor.i, neighbor.j) && is_on_bag_border(neighbor))
                 {
                     on_edge.at(neighbor.i, neighbor.j) = true;
                     edges.push_back(neighbor);
@@ -477,105 +523,35 @@ std::unique_ptr<Puzzle> Puzzle::generate_puzzle(size_t size)
             }
         }
     }
-//=============================================
-// label
-calc_targets_label:
+}
+
+void Puzzle::place_targets(Random& rand)
+{
     //---------------------------------------------
     // calculate the targets for the choosen cells
     //-------------------------------------------------
-    Cells<int32_t> targets(size, -3);
-    // top
-    for (CellIndexType j = 0; j < size; j++)
-    {
-        int32_t count = 0;
-        for (CellIndexType i = 0; i < size; i++)
-        {
-            if (puzzle->m_cell_state.at(i, j) == CellState::in_bag)
-            {
-                count++;
-            }
-            else
-            {
-                count = 0;
-            }
+    Cells<int32_t> targets(m_size);
+    compute_visibility_map(m_cell_state, targets);
 
-            targets.at(i, j) += count;
-        }
-    }
-    // left
-    for (CellIndexType i = 0; i < size; i++)
-    {
-        int32_t count = 0;
-        for (CellIndexType j = 0; j < size; j++)
-        {
-            if (puzzle->m_cell_state.at(i, j) == CellState::in_bag)
-            {
-                count++;
-            }
-            else
-            {
-                count = 0;
-            }
-
-            targets.at(i, j) += count;
-        }
-    }
-    // right
-    for (CellIndexType i = 0; i < size; i++)
-    {
-        int32_t count = 0;
-        for (CellIndexType j = size - 1; j >= 0; j--)
-        {
-            if (puzzle->m_cell_state.at(i, j) == CellState::in_bag)
-            {
-                count++;
-            }
-            else
-            {
-                count = 0;
-            }
-
-            targets.at(i, j) += count;
-        }
-    }
-    // bottom
-    for (CellIndexType j = 0; j < size; j++)
-    {
-        int32_t count = 0;
-        for (CellIndexType i = size - 1; i >= 0; i--)
-        {
-            if (puzzle->m_cell_state.at(i, j) == CellState::in_bag)
-            {
-                count++;
-            }
-            else
-            {
-                count = 0;
-            }
-
-            targets.at(i, j) += count;
-        }
-    }
-
-    puzzle->m_targets.clear();
-    // for (CellIndexType i = 0; i < size; i++)
+    m_targets.clear();
+    // for (CellIndexType i = 0; i < m_size; i++)
     // {
-    //     for (CellIndexType j = 0; j < size; j++)
+    //     for (CellIndexType j = 0; j < m_size; j++)
     //     {
-    //         if (puzzle->is_in_bag({i, j}))
+    //         if (is_in_bag({i, j}))
     //         {
-    //             puzzle->m_targets.push_back({{i, j}, targets.at(i, j)});
+    //             m_targets.push_back({{i, j}, targets.at(i, j)});
     //         }
     //     }
     // }
 
     std::vector<CellTarget> candidates;
-    for (CellIndexType i = 0; i < size; i++)
+    for (CellIndexType i = 0; i < m_size; i++)
     {
         candidates.clear();
-        for (CellIndexType j = 0; j < size; j++)
+        for (CellIndexType j = 0; j < m_size; j++)
         {
-            if (puzzle->is_in_bag({i,j}))
+            if (is_in_bag({i,j}))
             {
                 candidates.push_back({{i, j}, targets.at(i, j)});
             }
@@ -599,13 +575,9 @@ calc_targets_label:
                     sammple_size = 3;
                 }
             }
-            std::sample(candidates.begin(), candidates.end(), std::back_inserter(puzzle->m_targets), sammple_size, rand.rng);
+            rand.sample(candidates, sammple_size, std::back_inserter(m_targets));
         }
     }
-
-    puzzle->restart();
-
-    return puzzle;
 }
 
 void Puzzle::check_if_solved()
@@ -784,3 +756,25 @@ size_t Puzzle::get_size()
 {
     return m_size;
 }
+
+uint64_t Puzzle::get_fingerprint()
+{
+    // FNV-1a over the size and the clues, enough to tell two puzzles apart
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int byte = 0; byte < 8; byte++)
+        {
+            hash ^= (value >> (byte * 8)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+
+    mix(m_size);
+    for (auto &[pos, target] : m_targets)
+    {
+        mix(static_cast<uint64_t>(pos.i));
+        mix(static_cast<uint64_t>(pos.j));
+        mix(static_cast<uint64_t>(target));
+    }
+    return hash;
+}
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <vector>
+#include <memory>
 
 enum class CellState {
     out_of_bag,
@@ -45,6 +46,14 @@ struct Cells {
         m_buffer = new T[m_size * m_size];
     }
 
+    Cells(const Cells&) = delete;
+    Cells& operator=(const Cells&) = delete;
+
+    Cells(Cells&& other) : m_buffer(other.m_buffer), m_size(other.m_size) {
+        other.m_buffer = nullptr;
+        other.m_size = 0;
+    }
+
     ~Cells() {
         delete[] m_buffer;
     }
@@ -72,6 +81,15 @@ struct Cells {
     
 };
 
+enum class GenerationMode {
+    edge_peeling,   // original carving, rescans the whole bag for every removed cell
+    frontier,       // keeps the removable cells incrementally, for large boards (50x50 and up)
+    mcmc            // samples the shape uniformly with McmcShapeSampler, less blobby
+};
+
+struct Random;
+class BagShape;
+
 struct CellTarget{
     CellPosition pos;
     int32_t target;
@@ -97,7 +115,13 @@ public:
 
     void trace_bag_border_points(std::vector<CellPosition>& bag_border_points);
 
-    static std::unique_ptr<Puzzle> generate_puzzle(size_t size);
+    uint64_t get_fingerprint();
+
+    // same (size, seed, mode) always gives the same puzzle
+    static std::unique_ptr<Puzzle> generate_puzzle(size_t size, uint64_t seed, GenerationMode mode = GenerationMode::edge_peeling);
+    // places the targets on a shape made elsewhere, e.g. by sample_shapes. the same
+    // (shape, seed) always gives the same puzzle
+    static std::unique_ptr<Puzzle> generate_puzzle_from_shape(BagShape& shape, uint64_t seed);
 
     uint64_t m_seed;
 
@@ -129,4 +153,7 @@ private:
     bool is_outside_bag_border(CellPosition pos);
 
     void check_if_solved();
+
+    void carve_by_edge_peeling(size_t num_empty_cells, Random& rand);
+    void place_targets(Random& rand);
 };
@@ -0,0 +1,159 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "puzzle_quality.h"
+#include "random.h"
+#include "thread_pool.h"
+
+PuzzleScore score_puzzle(Puzzle& puzzle, const ScoringWeights& weights, size_t node_budget, cancel_check_callback cancel_check, void* ctx)
+{
+    const size_t size = puzzle.get_size();
+    PuzzleScore score;
+    score.clue_count = puzzle.get_targets().size();
+
+    PuzzleSolver solver(size, puzzle.get_targets());
+    solver.set_cancel_check(cancel_check, ctx);
+    const PuzzleSolver::Result result = solver.solve(node_budget);
+    if (result != PuzzleSolver::Result::unique && result != PuzzleSolver::Result::multiple)
+    {
+        return score;
+    }
+    score.unique = result == PuzzleSolver::Result::unique;
+    score.difficulty_grade = solver.get_difficulty_grade();
+
+    // 16 * area / perimeter^2 of the (first) solution, 1 for a square
+    size_t area = 0;
+    size_t perimeter = 0;
+    for (CellIndexType i = 0; i < size; i++)
+    {
+        for (CellIndexType j = 0; j < size; j++)
+        {
+            if (!solver.is_in_bag_in_solution({i, j}))
+            {
+                continue;
+            }
+            area++;
+            perimeter += (i == 0 || !solver.is_in_bag_in_solution({i - 1, j}));
+            perimeter += (j == 0 || !solver.is_in_bag_in_solution({i, j - 1}));
+            perimeter += (i + 1 == size || !solver.is_in_bag_in_solution({i + 1, j}));
+            perimeter += (j + 1 == size || !solver.is_in_bag_in_solution({i, j + 1}));
+        }
+    }
+    score.compactness = perimeter ? 16.0f * area / static_cast<float>(perimeter * perimeter) : 0.0f;
+
+    const float clue_score = std::clamp(1.0f - score.clue_count / (3.0f * size), 0.0f, 1.0f);
+    const float difficulty_score = (score.difficulty_grade - PuzzleSolver::grade_clues) / static_cast<float>(PuzzleSolver::grade_search - PuzzleSolver::grade_clues);
+    const float compactness_range = std::max(weights.compactness_target, 1.0f - weights.compactness_target);
+    const float compactness_score = 1.0f - std::min(1.0f, std::fabs(score.compactness - weights.compactness_target) / compactness_range);
+
+    score.total = weights.clues * clue_score + weights.difficulty * difficulty_score + weights.compactness * compactness_score;
+    if (!score.unique)
+    {
+        score.total *= weights.non_unique_factor;
+    }
+    return score;
+}
+
+struct CandidateCancelCheck {
+    std::atomic<size_t>* first_accepted;
+    size_t index;
+};
+
+BestOfKReport generate_best_puzzle(size_t size, uint64_t seed, const BestOfKConfig& config, ThreadPool& pool)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<Puzzle>> candidates(config.k);
+    std::vector<PuzzleScore> scores(config.k);
+    std::vector<uint8_t> scored(config.k, 0);
+    std::atomic<size_t> first_accepted = SIZE_MAX;
+
+    // the chains fill a pool of at least k shapes, split the same way on any number of threads
+    std::vector<BagShape> shapes;
+    if (config.mode == GenerationMode::mcmc && config.mcmc_chains > 0)
+    {
+        const size_t num_chains = std::min(config.mcmc_chains, config.k);
+        shapes = sample_shapes(size, config.mcmc, seed, num_chains, (config.k + num_chains - 1) / num_chains, pool);
+    }
+
+    for (size_t index = 0; index < config.k; index++)
+    {
+        pool.submit([&, index]{
+            // a lower index already won, nothing this candidate does can matter
+            if (first_accepted.load() < index)
+            {
+                return;
+            }
+            candidates[index] = shapes.empty()
+                ? Puzzle::generate_puzzle(size, Random::mix_seed(seed, index), config.mode)
+                : Puzzle::generate_puzzle_from_shape(shapes[index], Random::mix_seed(seed, index));
+
+            CandidateCancelCheck cancel_check = {&first_accepted, index};
+            scores[index] = score_puzzle(*candidates[index], config.weights, config.node_budget, [](void* ctx){
+                auto check = static_cast<CandidateCancelCheck*>(ctx);
+                return check->first_accepted->load() < check->index;
+            }, &cancel_check);
+            if (first_accepted.load() < index)
+            {
+                return;
+            }
+            scored[index] = 1;
+
+            if (scores[index].unique && scores[index].total >= config.accept_score)
+            {
+                size_t current = first_accepted.load();
+                while (index < current && !first_accepted.compare_exchange_weak(current, index))
+                {
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    BestOfKReport report;
+    report.min_score = 1.0f;
+    float score_sum = 0.0f;
+    bool has_best = false;
+    const size_t winner = first_accepted.load();
+    for (size_t index = 0; index < config.k; index++)
+    {
+        if (!scored[index] || index > winner)
+        {
+            report.candidates_cancelled++;
+            continue;
+        }
+        const PuzzleScore& score = scores[index];
+        report.candidates_scored++;
+        report.unique_candidates += score.unique;
+        report.min_score = std::min(report.min_score, score.total);
+        report.max_score = std::max(report.max_score, score.total);
+        score_sum += score.total;
+        report.score_histogram[std::min<size_t>(9, static_cast<size_t>(score.total * 10))]++;
+
+        // an ambiguous puzzle is never featured, however well it scores otherwise
+        if (score.unique && (!has_best || (winner == SIZE_MAX ? score.total > report.best_score.total : index == winner)))
+        {
+            has_best = true;
+            report.best_index = index;
+            report.best_score = score;
+        }
+    }
+
+    if (has_best)
+    {
+        report.best = std::move(candidates[report.best_index]);
+    }
+    if (report.candidates_scored > 0)
+    {
+        report.mean_score = score_sum / report.candidates_scored;
+    }
+    else
+    {
+        report.min_score = 0.0f;
+    }
+
+    report.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    report.candidates_per_second = report.elapsed_seconds > 0 ? report.candidates_scored / report.elapsed_seconds : 0.0;
+    return report;
+}
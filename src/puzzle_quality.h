@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include "puzzle.h"
+#include "puzzle_solver.h"
+#include "shape_sampler.h"
+
+class ThreadPool;
+
+struct ScoringWeights {
+    float clues = 0.3f;                 // fewer clues is better
+    float difficulty = 0.5f;            // a higher grade is better
+    float compactness = 0.2f;           // closer to compactness_target is better
+    float compactness_target = 0.5f;    // 1 is a square, lower is more spread out
+    float non_unique_factor = 0.5f;     // puzzles with several solutions still get a score, they can't win
+};
+
+struct PuzzleScore {
+    bool unique = false;
+    size_t clue_count = 0;
+    uint32_t difficulty_grade = 0;
+    float compactness = 0.0f;
+    float total = 0.0f;
+};
+
+// scores a freshly generated puzzle, the solver may be cut short with cancel_check
+PuzzleScore score_puzzle(Puzzle& puzzle, const ScoringWeights& weights, size_t node_budget, cancel_check_callback cancel_check = nullptr, void* ctx = nullptr);
+
+struct BestOfKConfig {
+    size_t k = 32;
+    float accept_score = 0.75f;     // the first candidate reaching this wins, later ones are cancelled
+    GenerationMode mode = GenerationMode::edge_peeling;
+    // in mcmc mode the candidate shapes come from this many independent chains sampled up
+    // front with sample_shapes, candidate i is shape i
+    size_t mcmc_chains = 8;
+    McmcConfig mcmc;
+    ScoringWeights weights;
+    size_t node_budget = 200000;
+};
+
+struct BestOfKReport {
+    std::unique_ptr<Puzzle> best;
+    PuzzleScore best_score;
+    size_t best_index = 0;
+    size_t candidates_scored = 0;
+    size_t candidates_cancelled = 0;
+    size_t unique_candidates = 0;
+    double elapsed_seconds = 0.0;
+    double candidates_per_second = 0.0;
+    float min_score = 0.0f;
+    float mean_score = 0.0f;
+    float max_score = 0.0f;
+    std::array<size_t, 10> score_histogram{};  // scored candidates per 0.1 wide bucket
+};
+
+// generates k candidates on the pool and keeps the best unique one, best is null if none
+// is unique. candidate i uses the seed mix_seed(seed, i) (in mcmc mode the i-th shape of
+// the chains) and the winner is the lowest index reaching accept_score (or the best score,
+// lowest index on ties) so the result doesn't depend on scheduling
+BestOfKReport generate_best_puzzle(size_t size, uint64_t seed, const BestOfKConfig& config, ThreadPool& pool);
@@ -0,0 +1,478 @@
+#include "puzzle_solver.h"
+
+static const int32_t move_i[] = {-1, 0, 1, 0};
+static const int32_t move_j[] = {0, -1, 0, 1};
+
+PuzzleSolver::PuzzleSolver(size_t size, const std::vector<CellTarget>& targets)
+:   m_size(size),
+    m_targets(targets),
+    m_component(size * size),
+    m_stack()
+{
+    m_stack.reserve(size * size);
+}
+
+void PuzzleSolver::set_cancel_check(cancel_check_callback callback, void* ctx)
+{
+    m_cancel_check = callback;
+    m_cancel_check_ctx = ctx;
+}
+
+uint32_t PuzzleSolver::get_difficulty_grade()
+{
+    return m_difficulty_grade;
+}
+
+size_t PuzzleSolver::get_nodes_visited()
+{
+    return m_nodes_visited;
+}
+
+bool PuzzleSolver::is_in_bag_in_solution(CellPosition pos)
+{
+    return m_solution[index_of(pos.i, pos.j)] == in_bag;
+}
+
+bool PuzzleSolver::should_stop()
+{
+    if (m_nodes_visited >= m_node_budget)
+    {
+        return true;
+    }
+    // the callback may touch atomics, don't pay for it on every node
+    if (m_cancel_check && (m_nodes_visited & 63) == 0)
+    {
+        return m_cancel_check(m_cancel_check_ctx);
+    }
+    return false;
+}
+
+PuzzleSolver::Result PuzzleSolver::solve(size_t node_budget)
+{
+    m_node_budget = node_budget;
+    m_nodes_visited = 0;
+    m_solutions_found = 0;
+    m_gave_up = false;
+    m_difficulty_grade = 0;
+
+    State state(m_size * m_size, unknown);
+    for (auto &[pos, target] : m_targets)
+    {
+        state[index_of(pos.i, pos.j)] = in_bag;
+    }
+
+    if (!propagate(state, grade_clues))
+    {
+        return Result::no_solution;
+    }
+    m_difficulty_grade = grade_clues;
+    if (!is_complete(state))
+    {
+        m_difficulty_grade = grade_regions;
+    }
+    // the clue rules alone don't look at connectivity, run the full set even on a complete grid
+    if (!propagate(state, grade_regions))
+    {
+        return Result::no_solution;
+    }
+
+    if (!is_complete(state))
+    {
+        m_difficulty_grade = grade_single_guess;
+        if (!apply_single_guesses(state))
+        {
+            return m_gave_up ? Result::gave_up : Result::no_solution;
+        }
+    }
+
+    // every deduction so far holds in all solutions, so a complete grid is the only one
+    if (is_complete(state))
+    {
+        m_solution = state;
+        m_solutions_found = 1;
+        return Result::unique;
+    }
+
+    m_difficulty_grade = grade_search;
+    search(state);
+
+    if (m_solutions_found >= 2)
+    {
+        return Result::multiple;
+    }
+    if (m_gave_up)
+    {
+        return Result::gave_up;
+    }
+    return m_solutions_found == 1 ? Result::unique : Result::no_solution;
+}
+
+bool PuzzleSolver::set_cell(State& state, size_t index, uint8_t value, bool& changed)
+{
+    if (state[index] == unknown)
+    {
+        state[index] = value;
+        changed = true;
+        return true;
+    }
+    return state[index] == value;
+}
+
+bool PuzzleSolver::propagate(State& state, uint32_t grade)
+{
+    bool changed;
+    do
+    {
+        changed = false;
+        if (!apply_clue_rules(state, changed))
+        {
+            return false;
+        }
+        if (grade >= grade_regions)
+        {
+            if (!apply_checkerboard_rule(state, changed) || !apply_region_rules(state, changed))
+            {
+                return false;
+            }
+        }
+    } while (changed);
+
+    return true;
+}
+
+bool PuzzleSolver::apply_clue_rules(State& state, bool& changed)
+{
+    const CellIndexType size = static_cast<CellIndexType>(m_size);
+
+    for (auto &[pos, target] : m_targets)
+    {
+        // per direction: cells that are surely visible and cells that could be visible
+        int32_t min_run[4];
+        int32_t max_run[4];
+        int32_t sum_min = 0;
+        int32_t sum_max = 0;
+
+        for (int d = 0; d < 4; d++)
+        {
+            CellIndexType i = pos.i + move_i[d];
+            CellIndexType j = pos.j + move_j[d];
+            int32_t run = 0;
+            while (i >= 0 && j >= 0 && i < size && j < size && state[index_of(i, j)] == in_bag)
+            {
+                run++;
+                i += move_i[d];
+                j += move_j[d];
+            }
+            min_run[d] = run;
+            while (i >= 0 && j >= 0 && i < size && j < size && state[index_of(i, j)] != out_of_bag)
+            {
+                run++;
+                i += move_i[d];
+                j += move_j[d];
+            }
+            max_run[d] = run;
+
+            sum_min += min_run[d];
+            sum_max += max_run[d];
+        }
+
+        if (1 + sum_min > target || 1 + sum_max < target)
+        {
+            return false;
+        }
+
+        for (int d = 0; d < 4; d++)
+        {
+            // the cell right after the sure run, if it joined it would drag in the in bag cells behind it
+            CellIndexType i = pos.i + move_i[d] * (min_run[d] + 1);
+            CellIndexType j = pos.j + move_j[d] * (min_run[d] + 1);
+            if (i >= 0 && j >= 0 && i < size && j < size && state[index_of(i, j)] == unknown)
+            {
+                int32_t extended = min_run[d] + 1;
+                CellIndexType ni = i + move_i[d];
+                CellIndexType nj = j + move_j[d];
+                while (ni >= 0 && nj >= 0 && ni < size && nj < size && state[index_of(ni, nj)] == in_bag)
+                {
+                    extended++;
+                    ni += move_i[d];
+                    nj += move_j[d];
+                }
+                if (1 + sum_min - min_run[d] + extended > target)
+                {
+                    set_cell(state, index_of(i, j), out_of_bag, changed);
+                }
+            }
+
+            // whatever the other directions can't provide has to come from this one
+            const int32_t needed = target - 1 - (sum_max - max_run[d]);
+            for (int32_t k = min_run[d] + 1; k <= needed; k++)
+            {
+                if (!set_cell(state, index_of(pos.i + move_i[d] * k, pos.j + move_j[d] * k), in_bag, changed))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool PuzzleSolver::apply_checkerboard_rule(State& state, bool& changed)
+{
+    // a 2x2 block can't be a checkerboard, the border would touch itself at the corner
+    for (CellIndexType i = 0; i + 1 < m_size; i++)
+    {
+        for (CellIndexType j = 0; j + 1 < m_size; j++)
+        {
+            const size_t a = index_of(i, j);
+            const size_t b = index_of(i, j + 1);
+            const size_t c = index_of(i + 1, j);
+            const size_t d = index_of(i + 1, j + 1);
+            const size_t diagonals[2][4] = {{a, d, b, c}, {b, c, a, d}};
+
+            for (auto &[first, second, other_first, other_second] : diagonals)
+            {
+                const uint8_t value = state[first];
+                if (value == unknown || state[second] != value)
+                {
+                    continue;
+                }
+                const uint8_t opposite = value == in_bag ? out_of_bag : in_bag;
+                if (state[other_first] == opposite && !set_cell(state, other_second, value, changed))
+                {
+                    return false;
+                }
+                if (state[other_second] == opposite && !set_cell(state, other_first, value, changed))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool PuzzleSolver::apply_region_rules(State& state, bool& changed)
+{
+    const CellIndexType size = static_cast<CellIndexType>(m_size);
+
+    // labels the components of the cells that are not `excluded`,
+    // reports per component whether it touches the grid border and whether it has a `marked` cell
+    std::vector<uint8_t> touches_border;
+    std::vector<uint8_t> has_marked;
+    auto label_components = [&](uint8_t excluded, uint8_t marked) {
+        touches_border.clear();
+        has_marked.clear();
+        std::fill(m_component.begin(), m_component.end(), -1);
+
+        for (size_t start = 0; start < state.size(); start++)
+        {
+            if (state[start] == excluded || m_component[start] != -1)
+            {
+                continue;
+            }
+            const int32_t component = static_cast<int32_t>(touches_border.size());
+            touches_border.push_back(0);
+            has_marked.push_back(0);
+
+            m_component[start] = component;
+            m_stack.clear();
+            m_stack.push_back(static_cast<int32_t>(start));
+            while (!m_stack.empty())
+            {
+                const int32_t index = m_stack.back();
+                m_stack.pop_back();
+                const CellIndexType i = index / size;
+                const CellIndexType j = index % size;
+                if (i == 0 || j == 0 || i == size - 1 || j == size - 1)
+                {
+                    touches_border[component] = 1;
+                }
+                if (state[index] == marked)
+                {
+                    has_marked[component] = 1;
+                }
+                for (int d = 0; d < 4; d++)
+                {
+                    const CellIndexType ni = i + move_i[d];
+                    const CellIndexType nj = j + move_j[d];
+                    if (ni < 0 || nj < 0 || ni >= size || nj >= size)
+                    {
+                        continue;
+                    }
+                    const size_t neighbor = index_of(ni, nj);
+                    if (state[neighbor] != excluded && m_component[neighbor] == -1)
+                    {
+                        m_component[neighbor] = component;
+                        m_stack.push_back(static_cast<int32_t>(neighbor));
+                    }
+                }
+            }
+        }
+    };
+
+    // the outside has to reach the border of the grid, cells that can't are in the bag
+    label_components(in_bag, out_of_bag);
+    for (size_t index = 0; index < state.size(); index++)
+    {
+        const int32_t component = m_component[index];
+        if (component == -1 || touches_border[component])
+        {
+            continue;
+        }
+        if (state[index] == out_of_bag)
+        {
+            return false;
+        }
+        set_cell(state, index, in_bag, changed);
+    }
+
+    // the bag has to be connected, cells that can't reach it are outside
+    label_components(out_of_bag, in_bag);
+    int32_t bag_component = -1;
+    for (size_t component = 0; component < has_marked.size(); component++)
+    {
+        if (has_marked[component])
+        {
+            if (bag_component != -1)
+            {
+                return false;
+            }
+            bag_component = static_cast<int32_t>(component);
+        }
+    }
+    if (bag_component != -1)
+    {
+        for (size_t index = 0; index < state.size(); index++)
+        {
+            if (m_component[index] != -1 && m_component[index] != bag_component)
+            {
+                set_cell(state, index, out_of_bag, changed);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool PuzzleSolver::apply_single_guesses(State& state)
+{
+    bool progress;
+    do
+    {
+        progress = false;
+        for (size_t index = 0; index < state.size() && !progress; index++)
+        {
+            if (state[index] != unknown)
+            {
+                continue;
+            }
+            for (uint8_t guess : {in_bag, out_of_bag})
+            {
+                if (should_stop())
+                {
+                    m_gave_up = true;
+                    return false;
+                }
+                m_nodes_visited++;
+
+                State trial = state;
+                trial[index] = guess;
+                if (!propagate(trial, grade_regions))
+                {
+                    state[index] = guess == in_bag ? out_of_bag : in_bag;
+                    if (!propagate(state, grade_regions))
+                    {
+                        return false;
+                    }
+                    progress = true;
+                    break;
+                }
+            }
+        }
+    } while (progress && !is_complete(state));
+
+    return true;
+}
+
+bool PuzzleSolver::is_complete(const State& state)
+{
+    for (uint8_t value : state)
+    {
+        if (value == unknown)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PuzzleSolver::pick_branch_cell(const State& state)
+{
+    // prefer cells touching the bag, the clue rules bite sooner there
+    size_t first_unknown = SIZE_MAX;
+    const CellIndexType size = static_cast<CellIndexType>(m_size);
+    for (CellIndexType i = 0; i < size; i++)
+    {
+        for (CellIndexType j = 0; j < size; j++)
+        {
+            if (state[index_of(i, j)] != unknown)
+            {
+                continue;
+            }
+            if (first_unknown == SIZE_MAX)
+            {
+                first_unknown = index_of(i, j);
+            }
+            for (int d = 0; d < 4; d++)
+            {
+                const CellIndexType ni = i + move_i[d];
+                const CellIndexType nj = j + move_j[d];
+                if (ni >= 0 && nj >= 0 && ni < size && nj < size && state[index_of(ni, nj)] == in_bag)
+                {
+                    return index_of(i, j);
+                }
+            }
+        }
+    }
+    return first_unknown;
+}
+
+void PuzzleSolver::search(State& state)
+{
+    if (should_stop())
+    {
+        m_gave_up = true;
+        return;
+    }
+    m_nodes_visited++;
+
+    if (!propagate(state, grade_regions))
+    {
+        return;
+    }
+
+    const size_t cell = pick_branch_cell(state);
+    if (cell == SIZE_MAX)
+    {
+        if (m_solutions_found == 0)
+        {
+            m_solution = state;
+        }
+        m_solutions_found++;
+        return;
+    }
+
+    for (uint8_t value : {in_bag, out_of_bag})
+    {
+        State next = state;
+        next[cell] = value;
+        search(next);
+        if (m_solutions_found >= 2 || m_gave_up)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "puzzle.h"
+
+typedef bool (*cancel_check_callback)(void* ctx);
+
+// deduces the bag of a puzzle from its clues.
+// solve() first applies deductions in increasing strength (the weakest one that is enough is the
+// difficulty grade), if they get stuck it falls back to a search that stops at the second solution.
+class PuzzleSolver {
+public:
+    enum class Result {
+        unique,
+        multiple,
+        no_solution,
+        gave_up     // ran out of node budget or was cancelled
+    };
+
+    enum DifficultyGrade : uint32_t {
+        grade_clues = 1,        // looking along the clue rows and columns is enough
+        grade_regions = 2,      // also needs connectivity of the bag / outside and the 2x2 rule
+        grade_single_guess = 3, // needs "if this cell was X it would break" on single cells
+        grade_search = 4        // needs nested guesses
+    };
+
+    PuzzleSolver(size_t size, const std::vector<CellTarget>& targets);
+
+    Result solve(size_t node_budget = 200000);
+
+    void set_cancel_check(cancel_check_callback callback, void* ctx);
+
+    uint32_t get_difficulty_grade();
+    size_t get_nodes_visited();
+    // only meaningful after solve() returned unique
+    bool is_in_bag_in_solution(CellPosition pos);
+
+private:
+    enum : uint8_t {
+        unknown = 0,
+        in_bag = 1,
+        out_of_bag = 2
+    };
+    using State = std::vector<uint8_t>;
+
+    size_t m_size;
+    std::vector<CellTarget> m_targets;
+    State m_solution;
+    size_t m_solutions_found = 0;
+    size_t m_nodes_visited = 0;
+    size_t m_node_budget = 0;
+    bool m_gave_up = false;
+    uint32_t m_difficulty_grade = 0;
+
+    cancel_check_callback m_cancel_check = nullptr;
+    void* m_cancel_check_ctx = nullptr;
+
+    // scratch buffers for the region passes
+    std::vector<int32_t> m_component;
+    std::vector<int32_t> m_stack;
+
+    inline size_t index_of(CellIndexType i, CellIndexType j) {
+        return i * m_size + j;
+    }
+
+    bool should_stop();
+    bool set_cell(State& state, size_t index, uint8_t value, bool& changed);
+    bool propagate(State& state, uint32_t grade);
+    bool apply_clue_rules(State& state, bool& changed);
+    bool apply_checkerboard_rule(State& state, bool& changed);
+    bool apply_region_rules(State& state, bool& changed);
+    bool apply_single_guesses(State& state);
+    bool is_complete(const State& state);
+    void search(State& state);
+    size_t pick_branch_cell(const State& state);
+};
@@ -1,21 +1,64 @@
+#pragma once
+
 #include <random>
+#include <vector>
 #include <cinttypes>
 #include <chrono>
 
+// every draw is computed here instead of going through the std distributions,
+// those are implementation defined so the same seed would give a different
+// puzzle on every standard library (native vs web builds, cached puzzles)
 struct Random {
-    std::default_random_engine rng;
+    std::mt19937_64 rng;
 
     Random(uint64_t seed) : rng(seed) {
     }
 
     float get_random_float_between_a_inclusive_b_inclusive(float a, float b) {
-        std::uniform_real_distribution<> dis(a, b);
-        return dis(rng);
+        // top 24 bits -> [0, 1]
+        const float unit = static_cast<float>(rng() >> 40) / static_cast<float>((1 << 24) - 1);
+        return a + (b - a) * unit;
     }
-    
+
     int32_t get_random_int_between_a_inclusive_b_inclusive(int32_t a, int32_t b) {
-        std::uniform_int_distribution<> dis(a, b);
-        return dis(rng);
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(b) - a) + 1;
+        // reject the tail so every value is equally likely
+        const uint64_t limit = UINT64_MAX - (UINT64_MAX % range);
+        uint64_t x;
+        do {
+            x = rng();
+        } while (x >= limit);
+        return static_cast<int32_t>(a + static_cast<int64_t>(x % range));
+    }
+
+    // picks sample_size elements keeping their relative order (Knuth's selection sampling)
+    template<typename T, typename OutputIt>
+    void sample(const std::vector<T>& population, size_t sample_size, OutputIt out) {
+        size_t remaining = population.size();
+        for (size_t i = 0; i < population.size() && sample_size > 0; i++, remaining--)
+        {
+            if (static_cast<size_t>(get_random_int_between_a_inclusive_b_inclusive(0, remaining - 1)) < sample_size)
+            {
+                *out++ = population[i];
+                sample_size--;
+            }
+        }
+    }
+
+    // splitmix64, derives independent streams from one seed (e.g. one per board size)
+    static uint64_t mix_seed(uint64_t seed, uint64_t stream) {
+        uint64_t z = seed + (stream + 1) * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // seeds of the puzzles asked for with "new puzzle", the n-th one after the puzzle of an
+    // hour. the top bit is set so they can never be an hour since the epoch, clicking through
+    // them never reaches an upcoming puzzle of the hour
+    static uint64_t get_extra_puzzle_seed(uint64_t hourly_seed, uint64_t n) {
+        constexpr uint64_t extra_puzzle_stream = 0x6e6577;  // "new"
+        return mix_seed(mix_seed(hourly_seed, extra_puzzle_stream), n) | (1ULL << 63);
     }
 
     static uint64_t get_hourly_seed() {
@@ -26,5 +69,3 @@ struct Random {
     }
 
 };
-
-
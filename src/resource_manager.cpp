@@ -1,5 +1,6 @@
 #include <iostream>
 #include "resource_manager.h"
+#include "profiler.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -35,6 +36,8 @@ SDL_Texture* LoadTexture(SDL_Renderer* renderer, const char* file) {
 
     // Convert to SDL Texture
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    PROFILE_COUNT(counter_textures_created, 1);
+    PROFILE_COUNT(counter_bytes_uploaded, width * height * 4);
     SDL_DestroySurface(surface); // Free SDL surface
     stbi_image_free(data);    // Free stb_image raw data
 
@@ -0,0 +1,86 @@
+#include <cmath>
+#include <algorithm>
+#include "shape_sampler.h"
+#include "thread_pool.h"
+
+McmcShapeSampler::McmcShapeSampler(size_t size, const McmcConfig& config, uint64_t seed)
+:   m_size(size),
+    m_config(config),
+    m_rand(seed),
+    m_shape(size)
+{
+    const float num_cells = static_cast<float>(size * size);
+    const float min_ratio = std::max(0.0f, config.fill_ratio - config.fill_tolerance);
+    const float max_ratio = std::min(1.0f, config.fill_ratio + config.fill_tolerance);
+    m_min_bag_cells = std::max<size_t>(1, static_cast<size_t>(std::ceil(num_cells * min_ratio)));
+    m_max_bag_cells = std::max(m_min_bag_cells, static_cast<size_t>(std::floor(num_cells * max_ratio)));
+
+    // start inside the band, the first next_shape() call doubles as the burn in
+    const size_t target_bag_cells = static_cast<size_t>(num_cells * config.fill_ratio);
+    const size_t start_bag_cells = std::clamp(target_bag_cells, m_min_bag_cells, m_max_bag_cells);
+    m_shape.carve(size * size - start_bag_cells, m_rand);
+
+    m_cell_indices.reserve(size * size);
+    for (CellIndexType i = 0; i < size; i++)
+    {
+        for (CellIndexType j = 0; j < size; j++)
+        {
+            m_cell_indices.push_back(static_cast<uint32_t>(m_shape.index_of({i, j})));
+        }
+    }
+}
+
+BagShape& McmcShapeSampler::next_shape()
+{
+    const uint64_t num_cells = m_cell_indices.size();
+    const size_t num_proposals = m_config.mixing_sweeps * num_cells;
+
+    // two proposals per draw, the cell is picked with a multiply-shift, its tiny bias does
+    // not depend on the shape so the proposal stays symmetric
+    for (size_t n = 0; n < num_proposals; n += 2)
+    {
+        const uint64_t bits = m_rand.rng();
+        propose_flip(m_cell_indices[((bits & 0xffffffff) * num_cells) >> 32]);
+        propose_flip(m_cell_indices[((bits >> 32) * num_cells) >> 32]);
+    }
+
+    return m_shape;
+}
+
+inline void McmcShapeSampler::propose_flip(size_t index)
+{
+    const size_t bag_cells = m_shape.m_bag_cell_count;
+    if (m_shape.m_in_bag[index] ? bag_cells <= m_min_bag_cells : bag_cells >= m_max_bag_cells)
+    {
+        return;
+    }
+
+    if (m_shape.can_flip(index))
+    {
+        m_shape.flip(index);
+        m_accepted_flips++;
+    }
+}
+
+size_t McmcShapeSampler::get_accepted_flips()
+{
+    return m_accepted_flips;
+}
+
+std::vector<BagShape> sample_shapes(size_t size, const McmcConfig& config, uint64_t seed, size_t num_chains, size_t shapes_per_chain, ThreadPool& pool)
+{
+    std::vector<BagShape> shapes(num_chains * shapes_per_chain, BagShape(0));
+    for (size_t chain = 0; chain < num_chains; chain++)
+    {
+        pool.submit([&shapes, &config, size, seed, chain, shapes_per_chain]{
+            McmcShapeSampler sampler(size, config, Random::mix_seed(seed, chain));
+            for (size_t n = 0; n < shapes_per_chain; n++)
+            {
+                shapes[chain * shapes_per_chain + n] = sampler.next_shape();
+            }
+        });
+    }
+    pool.wait();
+
+    return shapes;
+}
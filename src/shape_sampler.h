@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "bag_shape.h"
+#include "random.h"
+
+class ThreadPool;
+
+struct McmcConfig {
+    float fill_ratio = 0.6f;        // fraction of the cells inside the bag
+    float fill_tolerance = 0.05f;   // the chain never leaves fill_ratio +- fill_tolerance
+    size_t mixing_sweeps = 20;      // flip proposals per cell between two samples
+};
+
+// markov chain over hole free connected bags. every step proposes flipping a uniformly
+// picked cell and takes it if BagShape allows it and the bag size stays in the band,
+// the proposal is symmetric so the chain samples the shapes in the band uniformly
+// instead of favoring the blobs the edge peeling produces.
+class McmcShapeSampler {
+public:
+    McmcShapeSampler(size_t size, const McmcConfig& config, uint64_t seed);
+
+    // advances the chain by mixing_sweeps * size^2 proposals
+    BagShape& next_shape();
+
+    size_t get_accepted_flips();
+
+private:
+    size_t m_size;
+    McmcConfig m_config;
+    Random m_rand;
+    BagShape m_shape;
+    std::vector<uint32_t> m_cell_indices;   // BagShape index of every cell, avoids a division per proposal
+    size_t m_min_bag_cells;
+    size_t m_max_bag_cells;
+    size_t m_accepted_flips = 0;
+
+    void propose_flip(size_t index);
+};
+
+// runs num_chains independent chains on the pool, chain c is seeded with mix_seed(seed, c)
+// and its shapes land at [c * shapes_per_chain, (c + 1) * shapes_per_chain) so the result
+// does not depend on the number of threads
+std::vector<BagShape> sample_shapes(size_t size, const McmcConfig& config, uint64_t seed, size_t num_chains, size_t shapes_per_chain, ThreadPool& pool);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool {
+public:
+    ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+        for (size_t i = 0; i < num_threads; i++) {
+            m_workers.emplace_back([this]{ worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_task_available.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push(std::move(task));
+        }
+        m_task_available.notify_one();
+    }
+
+    // blocks until every submitted task has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_all_done.wait(lock, [this]{ return m_tasks.empty() && m_active_tasks == 0; });
+    }
+
+    size_t get_thread_count() {
+        return m_workers.size();
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_task_available;
+    std::condition_variable m_all_done;
+    size_t m_active_tasks = 0;
+    bool m_stopping = false;
+
+    void worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_task_available.wait(lock, [this]{ return m_stopping || !m_tasks.empty(); });
+                if (m_stopping && m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+                m_active_tasks++;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_active_tasks--;
+                if (m_tasks.empty() && m_active_tasks == 0) {
+                    m_all_done.notify_all();
+                }
+            }
+        }
+    }
+};
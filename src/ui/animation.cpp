@@ -0,0 +1,110 @@
+#include "animation.h"
+#include "view.h"
+
+Animator animator;
+
+static float apply_easing(Easing easing, float t)
+{
+    switch (easing) {
+        case Easing::ease_out_cubic: {
+            const float u = 1.0f - t;
+            return 1.0f - u * u * u;
+        }
+        case Easing::ease_in_out_cubic: {
+            if (t < 0.5f) {
+                return 4.0f * t * t * t;
+            }
+            const float u = -2.0f * t + 2.0f;
+            return 1.0f - u * u * u / 2.0f;
+        }
+        case Easing::linear:
+        default:
+            return t;
+    }
+}
+
+void Animator::animate(View* view, float* value, float to, float duration_ms, Easing easing, tween_finished_callback on_finished, void* ctx)
+{
+    cancel(value);
+    if (duration_ms <= 0.0f) {
+        *value = to;
+        view->request_redraw();
+        if (on_finished) on_finished(ctx);
+        return;
+    }
+    // the start time is taken on the next tick so a tween started after a long idle
+    // sleep doesn't jump ahead
+    m_tweens.push_back({view, value, *value, to, false, 0, static_cast<uint64_t>(duration_ms * 1e6f), easing, on_finished, ctx});
+    view->request_redraw();
+}
+
+void Animator::cancel(float* value)
+{
+    for (size_t i = 0; i < m_tweens.size(); i++) {
+        if (m_tweens[i].value == value) {
+            m_tweens[i] = m_tweens.back();
+            m_tweens.pop_back();
+            return;
+        }
+    }
+}
+
+void Animator::cancel_all(View* view)
+{
+    for (size_t i = 0; i < m_tweens.size();) {
+        if (m_tweens[i].view == view) {
+            m_tweens[i] = m_tweens.back();
+            m_tweens.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+void Animator::tick(uint64_t now_ns)
+{
+    m_now_ns = now_ns;
+
+    // finished callbacks may start new tweens, so they run after the sweep
+    struct Finished {
+        tween_finished_callback on_finished;
+        void* ctx;
+    };
+    std::vector<Finished> finished;
+
+    for (size_t i = 0; i < m_tweens.size();) {
+        Tween& tween = m_tweens[i];
+        if (!tween.started) {
+            tween.started = true;
+            tween.start_ns = now_ns;
+        }
+
+        const uint64_t elapsed_ns = now_ns - tween.start_ns;
+        const float t = elapsed_ns >= tween.duration_ns ? 1.0f : static_cast<float>(elapsed_ns) / tween.duration_ns;
+        *tween.value = tween.from + (tween.to - tween.from) * apply_easing(tween.easing, t);
+        // the view may derive state from the value in on_update
+        tween.view->request_update();
+        tween.view->request_redraw();
+
+        if (t >= 1.0f) {
+            if (tween.on_finished) {
+                finished.push_back({tween.on_finished, tween.ctx});
+            }
+            m_tweens[i] = m_tweens.back();
+            m_tweens.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+
+    for (auto& [on_finished, ctx] : finished) {
+        on_finished(ctx);
+    }
+}
+
+bool Animator::is_animating()
+{
+    return !m_tweens.empty();
+}
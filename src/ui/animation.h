@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class View;
+
+typedef void (*tween_finished_callback)(void* ctx);
+
+enum class Easing {
+    linear,
+    ease_out_cubic,
+    ease_in_out_cubic
+};
+
+// time based tweens of float members of views. the application ticks the animator once
+// per frame with a nanosecond clock, every running tween requests an update and a redraw
+// of its view so the main loop stays awake exactly as long as something is moving.
+class Animator {
+public:
+    // animates *value from its current value to `to`. a tween already running on the same
+    // value is replaced without calling its finished callback
+    void animate(View* view, float* value, float to, float duration_ms, Easing easing = Easing::ease_out_cubic, tween_finished_callback on_finished = nullptr, void* ctx = nullptr);
+    // stops the tween on value where it is, without calling its finished callback
+    void cancel(float* value);
+    // stops every tween of a view that is going away
+    void cancel_all(View* view);
+
+    void tick(uint64_t now_ns);
+    bool is_animating();
+
+private:
+    struct Tween {
+        View* view;
+        float* value;
+        float from;
+        float to;
+        bool started;           // the start time is set by the first tick
+        uint64_t start_ns;
+        uint64_t duration_ns;
+        Easing easing;
+        tween_finished_callback on_finished;
+        void* ctx;
+    };
+
+    std::vector<Tween> m_tweens;
+    uint64_t m_now_ns = 0;
+};
+
+extern Animator animator;
@@ -9,7 +9,10 @@ Button::Button(const ButtonStyle &style, SDL_Renderer *renderer, const std::stri
 :   View(style.view_style, renderer),
     m_text(text), 
     m_on_click_callback(on_click_callback),
-    m_ctx(ctx)
+    m_ctx(ctx),
+    m_button_canvas(renderer),
+    m_button_hovered_canvas(renderer),
+    m_button_pressed_canvas(renderer)
 {
     style.set_style_for_button(*this);
     m_label = new Label({}, renderer, text);
@@ -27,23 +30,24 @@ void Button::set_button_texture()
     const float w = SDL_ceilf(m_bounds.w);
     const float h = SDL_ceilf(m_bounds.h);
     
-    plutovg_surface_t* surface = plutovg_surface_create(w, h);
-    plutovg_canvas_t* canvas = plutovg_canvas_create(surface);
-
-    if (m_border_radius > 0) {
-        plutovg_canvas_round_rect(canvas, border_width, border_width, w - 2*border_width, h - 2*border_width, m_border_radius, m_border_radius);
-    } else {
-        plutovg_canvas_rect(canvas, border_width, border_width, w - 2*border_width, h - 2*border_width);
-    }
-    plutovg_canvas_save(canvas);
-
     const auto button_texture_data = {   
-        std::tie(m_button_texture, m_background_color),
-        std::tie(m_button_hovered_texture, m_hover_color),
-        std::tie(m_button_pressed_texture, m_pressed_color),
+        std::tie(m_button_canvas, m_background_color),
+        std::tie(m_button_hovered_canvas, m_hover_color),
+        std::tie(m_button_pressed_canvas, m_pressed_color),
     };
 
-    for (auto& [texture, button_color] : button_texture_data) {
+    for (auto& [button_canvas, button_color] : button_texture_data) {
+        plutovg_canvas_t* canvas = button_canvas.begin(w, h);
+        if (!canvas) {
+            continue;
+        }
+
+        if (m_border_radius > 0) {
+            plutovg_canvas_round_rect(canvas, border_width, border_width, w - 2*border_width, h - 2*border_width, m_border_radius, m_border_radius);
+        } else {
+            plutovg_canvas_rect(canvas, border_width, border_width, w - 2*border_width, h - 2*border_width);
+        }
+
         plutovg_canvas_set_rgb(canvas, button_color.r/255.0, button_color.g/255.0, button_color.b/255.0);
         plutovg_canvas_fill_preserve(canvas);
 
@@ -53,24 +57,8 @@ void Button::set_button_texture()
             plutovg_canvas_stroke_preserve(canvas);
         }
 
-        SDL_Surface* sdl_surface = SDL_CreateSurfaceFrom(
-            plutovg_surface_get_width(surface), 
-            plutovg_surface_get_height(surface),
-            SDL_PIXELFORMAT_ARGB8888,
-            plutovg_surface_get_data(surface),
-            plutovg_surface_get_stride(surface)
-        );
-
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
-        texture = SDL_CreateTextureFromSurface(m_renderer, sdl_surface);
-        SDL_DestroySurface(sdl_surface);
-        plutovg_canvas_restore(canvas);
+        button_canvas.end();
     }
-
-    plutovg_canvas_destroy(canvas);
-    plutovg_surface_destroy(surface);
 }
 
 void Button::on_update()
@@ -80,18 +68,18 @@ void Button::on_update()
 void Button::on_render()
 {
     
-    SDL_Texture* current_texture;
+    StreamingCanvas* current_canvas;
     if (m_button_state.button_down) {
-        current_texture = m_button_pressed_texture;
+        current_canvas = &m_button_pressed_canvas;
     }
     else if (m_button_state.button_hovered) {
-        current_texture = m_button_hovered_texture;
+        current_canvas = &m_button_hovered_canvas;
     }
     else {
-        current_texture = m_button_texture;
+        current_canvas = &m_button_canvas;
     }
 
-    if (current_texture) SDL_RenderTexture(m_renderer, current_texture, nullptr, &m_bounds);
+    if (current_canvas->get_texture()) SDL_RenderTexture(m_renderer, current_canvas->get_texture(), current_canvas->get_src_rect(), &m_bounds);
     
 }
 
@@ -125,5 +113,9 @@ void Button::on_click(InputState* input_state)
 
 void Button::on_resize()
 {
+    // the old textures get stretched into the new bounds until the size settles
+    if (is_live_resizing() && m_button_canvas.get_texture()) {
+        return;
+    }
     set_button_texture();
 }
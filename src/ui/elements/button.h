@@ -4,6 +4,7 @@
 
 #include "../view.h"
 #include "label.h"
+#include "../streaming_canvas.h"
 
 typedef void (*FuncPtr)(void*);
 
@@ -69,9 +70,9 @@ private:
     Label* m_label = nullptr;
     void* m_ctx;
     FuncPtr m_on_click_callback;
-    SDL_Texture* m_button_texture = nullptr;
-    SDL_Texture* m_button_hovered_texture = nullptr;
-    SDL_Texture* m_button_pressed_texture = nullptr;
+    StreamingCanvas m_button_canvas;
+    StreamingCanvas m_button_hovered_canvas;
+    StreamingCanvas m_button_pressed_canvas;
 
     struct ButtonState {
         bool button_down = false;
@@ -1,5 +1,6 @@
 #include "dropdown.h"
 #include "div.h"
+#include "../animation.h"
 
 Dropdown::Dropdown(const DropdownStyle &style, SDL_Renderer *renderer, const std::vector<std::string>& items, dropdown_selected_callback selected_callback, void* ctx)
 : View({
@@ -44,7 +45,11 @@ void Dropdown::on_update()
         }
         break;
     case opening:
-        m_dropdown_list->show();
+        if (!m_dropdown_list->is_showing()) {
+            m_dropdown_list->m_reveal = 0.0f;
+            m_dropdown_list->show();
+        }
+        animator.animate(m_dropdown_list, &m_dropdown_list->m_reveal, 1.0f, 150.0f);
         m_drop_down_list_state = open;
         break;
     case closed:
@@ -53,7 +58,9 @@ void Dropdown::on_update()
         }
         break;
     case closing:
-            m_dropdown_list->hide();
+            // reopening before this finishes replaces the tween, so the list isn't hidden
+            animator.animate(m_dropdown_list, &m_dropdown_list->m_reveal, 0.0f, 120.0f, Easing::ease_out_cubic,
+                [](void* list){ static_cast<DropdownList*>(list)->hide(); }, m_dropdown_list);
             m_drop_down_list_state = closed;
         break;
     case selection_changed:
@@ -63,6 +70,8 @@ void Dropdown::on_update()
     default:
         break;
     }
+    // while the list is out its hover state is polled, closed only our own events matter
+    set_continuous_update(m_drop_down_list_state != closed);
 }
 
 void Dropdown::on_render()
@@ -103,6 +112,12 @@ DropdownList::DropdownList(const ViewStyle &style, SDL_Renderer *renderer, Dropd
 
 void DropdownList::on_update()
 {
+    if (m_reveal < 1.0f) {
+        m_clip_rect = SDL_FRect{m_bounds.x, m_bounds.y, m_bounds.w, m_bounds.h * m_reveal};
+    }
+    else {
+        m_clip_rect.reset();
+    }
 }
 
 void DropdownList::on_render()
@@ -45,6 +45,8 @@ protected:
 
 private:
     bool m_hovered = false;
+    // how much of the list is uncovered, animated when it opens and closes
+    float m_reveal = 1.0f;
     std::vector<DropdownListItem*> m_items;
 };
 
@@ -1,40 +1,63 @@
 #include "icon.h"
 #include "SDL3_ttf/SDL_ttf.h"
 #include "../../resource_manager.h"
+#include "../../profiler.h"
 
 Icon::Icon(const ViewStyle &style, SDL_Renderer *renderer, const uint32_t code_point)
 :   View(style, renderer),
     m_code_point(code_point)
 {
-    set_icon_texture();
+    YGNodeSetMeasureFunc(m_layout_node, measure);
 }
 
-void Icon::set_icon_texture() {
-    float label_w = 0.0f;
-    float label_h = 0.0f;
+// the icon font size is fixed for now
+static constexpr int icon_point_size = 42;
+
+YGSize Icon::measure(YGNodeConstRef node, float width, YGMeasureMode width_mode, float height, YGMeasureMode height_mode)
+{
+    Icon* icon = static_cast<Icon*>(YGNodeGetContext(node));
+    if (!icon->m_icon_size_valid) {
+        // a glyph is rendered as a one character string, so it measures like one
+        char utf8[5] = {};
+        SDL_UCS4ToUTF8(icon->m_code_point, utf8);
+        int w = 0;
+        int h = 0;
+        if (!TTF_GetStringSize(font_manager.get_icon_font_for_point_size(icon_point_size), utf8, 0, &w, &h)) {
+            w = 0;
+            h = 0;
+        }
+        icon->m_icon_size = {static_cast<float>(w), static_cast<float>(h)};
+        icon->m_icon_size_valid = true;
+    }
+    return icon->m_icon_size;
+}
 
+void Icon::set_icon_texture() {
+    m_icon_texture_dirty = false;
     if (m_icon_texture) {
         SDL_DestroyTexture(m_icon_texture);
     }
     
-    SDL_Surface* icon_surface = TTF_RenderGlyph_Blended(font_manager.get_icon_font_for_point_size(42), m_code_point, {255, 255, 255, 255});
+    SDL_Surface* icon_surface = TTF_RenderGlyph_Blended(font_manager.get_icon_font_for_point_size(icon_point_size), m_code_point, {255, 255, 255, 255});
+    PROFILE_COUNT(counter_ttf_renders, 1);
 
     if (!icon_surface) {
         m_icon_texture = nullptr;
     }
     else {
         m_icon_texture = SDL_CreateTextureFromSurface(m_renderer, icon_surface);
+        PROFILE_COUNT(counter_textures_created, 1);
+        PROFILE_COUNT(counter_bytes_uploaded, icon_surface->pitch * icon_surface->h);
         SDL_DestroySurface(icon_surface);
-        label_w = m_icon_texture->w;
-        label_h = m_icon_texture->h;
     }
-
-    YGNodeStyleSetWidth(m_layout_node, label_w);
-    YGNodeStyleSetHeight(m_layout_node, label_h);
+    request_redraw();
 }
 
 void Icon::on_update()
 {
+    if (m_icon_texture_dirty) {
+        set_icon_texture();
+    }
 }
 
 void Icon::on_render()
@@ -44,8 +67,14 @@ void Icon::on_render()
 
 void Icon::set_code_point(const uint32_t code_point)
 {
+    if (code_point == m_code_point) {
+        return;
+    }
     m_code_point = code_point;
-    set_icon_texture();
+    m_icon_size_valid = false;
+    m_icon_texture_dirty = true;
+    YGNodeMarkDirty(m_layout_node);
+    request_update();
 }
 
 bool Icon::handle_event(Event &event)
@@ -19,6 +19,12 @@ private:
 
     uint32_t m_code_point;
     SDL_Texture* m_icon_texture = nullptr;
+    // like Label, measured for yoga from the font and rasterised in on_update
+    bool m_icon_texture_dirty = true;
+    bool m_icon_size_valid = false;
+    YGSize m_icon_size = {0.0f, 0.0f};
+
     void set_icon_texture();
+    static YGSize measure(YGNodeConstRef node, float width, YGMeasureMode width_mode, float height, YGMeasureMode height_mode);
     
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "label.h"
 #include "SDL3_ttf/SDL_ttf.h"
 #include "../../resource_manager.h"
+#include "../../profiler.h"
+#include "../animation.h"
 
 Label::Label(const ViewStyle &style, SDL_Renderer *renderer, const std::string &text, int point_size, SDL_Color text_color)
 :   View(style, renderer),
@@ -8,46 +10,83 @@ Label::Label(const ViewStyle &style, SDL_Renderer *renderer, const std::string &
     m_point_size(point_size),
     m_text_color(text_color)
 {
-    set_text_texture();
+    YGNodeSetMeasureFunc(m_layout_node, measure);
 }
 
-void Label::set_text_texture() {
-    float label_w = 0.0f;
-    float label_h = 0.0f;
+YGSize Label::measure(YGNodeConstRef node, float width, YGMeasureMode width_mode, float height, YGMeasureMode height_mode)
+{
+    Label* label = static_cast<Label*>(YGNodeGetContext(node));
+    if (!label->m_text_size_valid) {
+        // the same size the rasterised text gets, without rasterising it
+        int w = 0;
+        int h = 0;
+        if (label->m_text.empty() || !TTF_GetStringSize(font_manager.get_font_for_point_size(label->m_point_size), label->m_text.c_str(), 0, &w, &h)) {
+            w = 0;
+            h = 0;
+        }
+        label->m_text_size = {static_cast<float>(w), static_cast<float>(h)};
+        label->m_text_size_valid = true;
+    }
+    return label->m_text_size;
+}
 
+void Label::invalidate_text()
+{
+    m_text_size_valid = false;
+    m_text_texture_dirty = true;
+    YGNodeMarkDirty(m_layout_node);
+    request_update();
+}
+
+void Label::set_text_texture() {
+    m_text_texture_dirty = false;
     if (m_text_texture) {
         SDL_DestroyTexture(m_text_texture);
     }
     
     SDL_Surface* text_surface = TTF_RenderText_Blended(font_manager.get_font_for_point_size(m_point_size), m_text.c_str(), 0, m_text_color);
+    PROFILE_COUNT(counter_ttf_renders, 1);
 
     if (!text_surface) {
         m_text_texture = nullptr;
     }
     else {
         m_text_texture = SDL_CreateTextureFromSurface(m_renderer, text_surface);
+        PROFILE_COUNT(counter_textures_created, 1);
+        PROFILE_COUNT(counter_bytes_uploaded, text_surface->pitch * text_surface->h);
         SDL_DestroySurface(text_surface);
-        label_w = m_text_texture->w;
-        label_h = m_text_texture->h;
     }
-
-    YGNodeStyleSetWidth(m_layout_node, label_w);
-    YGNodeStyleSetHeight(m_layout_node, label_h);
+    request_redraw();
 }
 
 void Label::on_update()
 {
+    if (m_text_texture_dirty) {
+        set_text_texture();
+    }
 }
 
 void Label::on_render()
 {
-    if (m_text_texture) SDL_RenderTexture(m_renderer, m_text_texture, nullptr, &m_bounds);
+    if (m_text_texture) {
+        SDL_SetTextureAlphaMod(m_text_texture, static_cast<Uint8>(m_opacity * 255));
+        SDL_RenderTexture(m_renderer, m_text_texture, nullptr, &m_bounds);
+    }
+}
+
+void Label::fade_in(float duration_ms)
+{
+    m_opacity = 0.0f;
+    animator.animate(this, &m_opacity, 1.0f, duration_ms);
 }
 
 void Label::set_text(const std::string &text)
 {
+    if (text == m_text) {
+        return;
+    }
     m_text = text;
-    set_text_texture();
+    invalidate_text();
 }
 
 const std::string &Label::get_text()
@@ -57,8 +96,11 @@ const std::string &Label::get_text()
 
 void Label::set_point_size(int point_size)
 {
+    if (point_size == m_point_size) {
+        return;
+    }
     m_point_size = point_size;
-    set_text_texture();
+    invalidate_text();
 }
 
 bool Label::handle_event(Event &event)
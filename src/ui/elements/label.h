@@ -15,6 +15,9 @@ public:
 
     void set_point_size(int point_size);
 
+    // fades the label in from transparent
+    void fade_in(float duration_ms);
+
 protected:
     bool handle_event(Event& event) override;
 
@@ -23,7 +26,16 @@ private:
     std::string m_text;
     int m_point_size;
     SDL_Color m_text_color;
+    float m_opacity = 1.0f;
     SDL_Texture* m_text_texture = nullptr;
+    // the text is rasterised in on_update, which hidden views never get
+    bool m_text_texture_dirty = true;
+    // the size of the text at m_point_size, measured when yoga first asks for it
+    bool m_text_size_valid = false;
+    YGSize m_text_size = {0.0f, 0.0f};
+
     void set_text_texture();
+    void invalidate_text();
+    static YGSize measure(YGNodeConstRef node, float width, YGMeasureMode width_mode, float height, YGMeasureMode height_mode);
     
 };
\ No newline at end of file
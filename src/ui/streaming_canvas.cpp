@@ -0,0 +1,91 @@
+#include <cstring>
+#include "streaming_canvas.h"
+#include "../profiler.h"
+
+StreamingCanvas::StreamingCanvas(SDL_Renderer* renderer) : m_renderer(renderer)
+{
+}
+
+StreamingCanvas::~StreamingCanvas()
+{
+    end();
+    reset();
+}
+
+plutovg_canvas_t* StreamingCanvas::begin(int w, int h)
+{
+    end();
+    if (w <= 0 || h <= 0) {
+        m_has_drawing = false;
+        return nullptr;
+    }
+
+    // grow only, shrinking would just churn textures while the window is resized
+    if (!m_texture || m_texture->w < w || m_texture->h < h) {
+        const int texture_w = m_texture ? SDL_max(m_texture->w, w) : w;
+        const int texture_h = m_texture ? SDL_max(m_texture->h, h) : h;
+        reset();
+        m_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, texture_w, texture_h);
+        if (!m_texture) {
+            SDL_Log("Couldn't create streaming texture: %s", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+        PROFILE_COUNT(counter_textures_created, 1);
+    }
+
+    const SDL_Rect rect = {0, 0, w, h};
+    void* pixels;
+    int pitch;
+    if (!SDL_LockTexture(m_texture, &rect, &pixels, &pitch)) {
+        SDL_Log("Couldn't lock streaming texture: %s", SDL_GetError());
+        m_has_drawing = false;
+        return nullptr;
+    }
+
+    // locked memory is write only and not guaranteed to hold the previous drawing
+    unsigned char* row = static_cast<unsigned char*>(pixels);
+    for (int y = 0; y < h; y++) {
+        std::memset(row, 0, w * 4);
+        row += pitch;
+    }
+
+    m_surface = plutovg_surface_create_for_data(static_cast<unsigned char*>(pixels), w, h, pitch);
+    m_canvas = plutovg_canvas_create(m_surface);
+    m_src_rect = {0, 0, static_cast<float>(w), static_cast<float>(h)};
+    return m_canvas;
+}
+
+void StreamingCanvas::end()
+{
+    if (!m_canvas) {
+        return;
+    }
+    plutovg_canvas_destroy(m_canvas);
+    plutovg_surface_destroy(m_surface);
+    m_canvas = nullptr;
+    m_surface = nullptr;
+    SDL_UnlockTexture(m_texture);
+    m_has_drawing = true;
+    PROFILE_COUNT(counter_vector_rasterisations, 1);
+    PROFILE_COUNT(counter_bytes_uploaded, static_cast<uint64_t>(m_src_rect.w * m_src_rect.h * 4));
+}
+
+void StreamingCanvas::reset()
+{
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    m_has_drawing = false;
+}
+
+SDL_Texture* StreamingCanvas::get_texture()
+{
+    return m_has_drawing ? m_texture : nullptr;
+}
+
+const SDL_FRect* StreamingCanvas::get_src_rect()
+{
+    return &m_src_rect;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "SDL3/SDL.h"
+#include "plutovg.h"
+
+// a persistent streaming texture that plutovg draws into while it is locked, so a redraw
+// is a single upload instead of surface -> SDL_Surface -> new texture.
+// the texture only ever grows, a drawing uses its top left w x h part.
+class StreamingCanvas {
+public:
+    StreamingCanvas(SDL_Renderer* renderer);
+    ~StreamingCanvas();
+
+    StreamingCanvas(const StreamingCanvas&) = delete;
+    StreamingCanvas& operator=(const StreamingCanvas&) = delete;
+
+    // locks a cleared w x h region and returns a canvas drawing into it, nullptr on failure.
+    // every begin() has to be matched by an end() before the texture is rendered
+    plutovg_canvas_t* begin(int w, int h);
+    void end();
+
+    // drops the texture, get_texture() returns nullptr until the next drawing
+    void reset();
+
+    SDL_Texture* get_texture();
+    // the part of the texture holding the last drawing
+    const SDL_FRect* get_src_rect();
+
+private:
+    SDL_Renderer* m_renderer;
+    SDL_Texture* m_texture = nullptr;
+    plutovg_surface_t* m_surface = nullptr;
+    plutovg_canvas_t* m_canvas = nullptr;
+    bool m_has_drawing = false;
+    SDL_FRect m_src_rect = {0, 0, 0, 0};
+};
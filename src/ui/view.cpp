@@ -1,4 +1,7 @@
 #include "view.h"
+#include "../profiler.h"
+#include "animation.h"
+#include "view_controller.h"
 
 View::View(const ViewStyle& style, SDL_Renderer *renderer) :  m_renderer(renderer)
 {
@@ -9,6 +12,7 @@ View::View(const ViewStyle& style, SDL_Renderer *renderer) :  m_renderer(rendere
 
 View::~View()
 {
+    animator.cancel_all(this);
     const size_t child_count = YGNodeGetChildCount(m_layout_node);
     for (size_t i = 0; i < child_count; i++) {
         YGNodeRef child = YGNodeGetChild(m_layout_node, 0);
@@ -16,6 +20,9 @@ View::~View()
         delete static_cast<View*>(YGNodeGetContext(child));
     }
     YGNodeFree(m_layout_node);
+    if (m_layer_texture) {
+        SDL_DestroyTexture(m_layer_texture);
+    }
 }
 
 bool View::handle_event(Event& event)
@@ -41,11 +48,22 @@ bool View::handle_event(Event& event)
         case Event::mouse_move:
             on_mouse_move(event.m_input_state);
             break;
+        case Event::mouse_wheel:
+            on_mouse_wheel(event.m_input_state);
+            break;
+        case Event::key_down:
+            on_key_down(event.m_input_state);
+            break;
+        case Event::key_up:
+            on_key_up(event.m_input_state);
+            break;
     
     default:
         return false;
     }
 
+    request_redraw();
+    request_update();
     return true;
 }
 
@@ -79,8 +97,21 @@ void View::on_mouse_move(InputState* input_state)
 {
 }
 
+void View::on_mouse_wheel(InputState* input_state)
+{
+}
+
+void View::on_key_down(InputState* input_state)
+{
+}
+
+void View::on_key_up(InputState* input_state)
+{
+}
+
 void View::render()
 {
+    PROFILE_VIEW_SCOPE(section_view_render, this);
     on_render();
 }
 
@@ -95,38 +126,82 @@ void set_all_children_has_new_layout(YGNodeRef node) {
 }
 
 void View::update()
+{
+    PROFILE_VIEW_SCOPE(section_view_update, this);
+    on_update();
+}
+
+void View::update_layout()
 {
     if (YGNodeGetHasNewLayout(m_layout_node)) {
         update_bounds();
         on_resize();
+        request_redraw();
         YGNodeSetHasNewLayout(m_layout_node, false);
     }
-    on_update();
     // update children
     const size_t child_count = YGNodeGetChildCount(m_layout_node);
     for (size_t i = 0; i < child_count; i++) {
         YGNodeRef child = YGNodeGetChild(m_layout_node, i);
         if (YGNodeStyleGetDisplay(child) != YGDisplayNone) {
             View* child_view = static_cast<View*>(YGNodeGetContext(child));
-            child_view->update();
+            child_view->update_layout();
         }
     }
 }
 
+void View::request_update()
+{
+    if (s_view_controller) {
+        s_view_controller->schedule_update(this);
+    }
+}
+
+void View::set_continuous_update(bool continuous)
+{
+    if (s_view_controller) {
+        s_view_controller->set_continuous_update(this, continuous);
+    }
+}
+
+// show and hide leave the render list alone, hidden views are skipped with their subtree
 void View::show()
 {
     YGNodeStyleSetDisplay(m_layout_node, YGDisplayFlex);
+    request_redraw();
+    if (s_view_controller) {
+        s_view_controller->invalidate_hit_test();
+    }
 }
 
 void View::hide()
 {
     YGNodeStyleSetDisplay(m_layout_node, YGDisplayNone);
+    request_redraw();
+    if (s_view_controller) {
+        s_view_controller->invalidate_hit_test();
+    }
 }
 
 void View::insert_child(const View* child)
 {
     size_t index = YGNodeGetChildCount(m_layout_node);
     YGNodeInsertChild(m_layout_node, child->m_layout_node, index);
+    if (s_view_controller) {
+        s_view_controller->on_child_inserted(const_cast<View*>(child));
+    }
+}
+
+void View::set_z_index(int z_index)
+{
+    if (z_index == m_z_index) {
+        return;
+    }
+    m_z_index = z_index;
+    if (s_view_controller) {
+        s_view_controller->on_z_index_changed(this);
+    }
+    request_redraw();
 }
 
 void View::calc_layout(float w, float h)
@@ -139,11 +214,48 @@ bool View::is_dirty()
     return YGNodeIsDirty(m_layout_node);
 }
 
+void View::request_redraw()
+{
+    // ancestors of a flagged view are already flagged, so stop at the first one
+    View* view = this;
+    while (view && !view->m_needs_redraw) {
+        view->m_needs_redraw = true;
+        view = view->parent_view();
+    }
+}
+
+bool View::needs_redraw()
+{
+    return m_needs_redraw;
+}
+
+void View::clear_redraw_requests()
+{
+    m_needs_redraw = false;
+    const size_t child_count = YGNodeGetChildCount(m_layout_node);
+    for (size_t i = 0; i < child_count; i++) {
+        View* child_view = static_cast<View*>(YGNodeGetContext(YGNodeGetChild(m_layout_node, i)));
+        if (child_view->m_needs_redraw) {
+            child_view->clear_redraw_requests();
+        }
+    }
+}
+
 bool View::is_showing()
 {
     return YGNodeStyleGetDisplay(m_layout_node) != YGDisplayNone; 
 }
 
+bool View::is_displayed()
+{
+    for (View* view = this; view; view = view->parent_view()) {
+        if (!view->is_showing()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool View::contains_point(const SDL_FPoint& point)
 {
     return SDL_PointInRectFloat(&point, &m_bounds);
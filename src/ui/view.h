@@ -31,6 +31,8 @@ public:
         optional<float> border_radius;
         optional<SDL_Color> backgroundColor;
         optional<int> z_index;
+        // keep the subtree in a texture that is only redrawn when something in it changed
+        optional<bool> cache_layer;
 
         inline void set_style_for_view(View& view) const {
             // layout props
@@ -85,6 +87,9 @@ public:
             if (border_radius.has_value()) {
                 view.m_border_radius = border_radius.value();
             }
+            if (cache_layer.has_value()) {
+                view.m_cache_layer = cache_layer.value();
+            }
         }
     };
 
@@ -94,6 +99,8 @@ public:
 
     void render();
     void update();
+    // delivers on_resize to the views that got a new layout, only walked after a layout pass
+    void update_layout();
 
     void show();
     void hide();
@@ -101,11 +108,26 @@ public:
     void insert_child(const View* child);
     void calc_layout(float w, float h);
     bool is_dirty();
+    // when set the view and its children are clipped to it while rendering
+    inline const optional<SDL_FRect>& get_clip_rect() {
+        return m_clip_rect;
+    }
+    // marks the view and its ancestors so the next frame gets drawn
+    void request_redraw();
+    // on_update only runs for views that ask for it: once after a request, or on every frame
+    // while continuous. handling an event and entering the tree count as a request
+    void request_update();
+    void set_continuous_update(bool continuous);
+    bool needs_redraw();
     bool is_showing();
+    // showing, and so are all its ancestors
+    bool is_displayed();
     bool contains_point(const SDL_FPoint& point);
     inline int get_z_index() {
         return m_z_index;
     }
+    // moves the view and its subtree to another layer of the render list
+    void set_z_index(int z_index);
 
     inline bool is_enabled() {
         return m_enabled;
@@ -127,6 +149,14 @@ protected:
     float m_border_radius = 0.0f;
 
     bool m_enabled = true;
+    bool m_needs_redraw = true;
+    optional<SDL_FRect> m_clip_rect;
+
+    // true while the window is being resized, on_resize should keep expensive
+    // rasterisation for the relayout that follows once the size is stable
+    static inline bool is_live_resizing() {
+        return s_live_resizing;
+    }
 
     virtual void on_update() = 0;
     virtual void on_render() = 0;
@@ -140,11 +170,26 @@ protected:
     virtual void on_mouse_down(InputState* input_state);
     virtual void on_mouse_up(InputState* input_state);
     virtual void on_mouse_move(InputState* input_state);
+    virtual void on_mouse_wheel(InputState* input_state);
+    virtual void on_key_down(InputState* input_state);
+    virtual void on_key_up(InputState* input_state);
 
 private:
+    static inline bool s_live_resizing = false;
+    // told about inserts and z index changes so it can keep its render list current
+    static inline ViewController* s_view_controller = nullptr;
     View* m_filter_view = nullptr;
 
+    // drawn by the ViewController, the texture only grows so a live resize doesn't churn it
+    bool m_cache_layer = false;
+    SDL_Texture* m_layer_texture = nullptr;
+
+    // bookkeeping of the ViewController's update lists
+    bool m_update_requested = false;
+    bool m_continuous_update = false;
+
     void update_bounds();
+    void clear_redraw_requests();
     
     inline View* parent_view() {
         const YGNodeRef parent_layout_node = YGNodeGetParent(m_layout_node);
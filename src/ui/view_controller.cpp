@@ -1,109 +1,598 @@
 #include "view_controller.h"
 #include "../events/event.h"
+#include "../profiler.h"
+#include "../common.h"
 
 const int min_int = -1000;
 
-void dfs_insert(std::map<int, std::vector<View *>> &zmap, View *root, int z_index)
+#define POINTS_EQUAL(p1,p2) ((p1.x == p2.x) && (p1.y == p2.y))
+
+ViewController::ViewController(SDL_Renderer* renderer, View *root) : m_renderer(renderer), m_ui_root(root)
+{
+    insert_render_items(root);
+    View::s_view_controller = this;
+    // every view gets one on_update to start with
+    schedule_subtree_updates(root);
+}
+
+ViewController::~ViewController()
+{
+    View::s_view_controller = nullptr;
+    delete m_ui_root;
+}
+
+bool ViewController::is_in_tree(View* view)
+{
+    return m_ui_root->is_ancestor_of(view);
+}
+
+size_t ViewController::find_render_item(View* view)
 {
-    if (root->get_z_index() > z_index) {
-        z_index = root->get_z_index();
-        std::vector<View *> &render_queue = zmap[z_index];
-        render_queue.push_back(root);
+    for (size_t i = 0; i < m_render_list.size(); i++) {
+        if (m_render_list[i].view == view) {
+            return i;
+        }
     }
+    return m_render_list.size();
+}
 
-    size_t child_count = root->get_child_count();
-    for (size_t i = 0; i < child_count; ++i)
-    {
-        dfs_insert(zmap, root->get_child(i), z_index);
+// the layer a view is drawn in is the highest z index from the root down to it
+int ViewController::get_layer(View* view)
+{
+    int layer = min_int;
+    for (; view; view = view->parent_view()) {
+        layer = SDL_max(layer, view->get_z_index());
     }
+    return layer;
 }
 
-ViewController::ViewController(SDL_Renderer* renderer, View *root) : m_renderer(renderer), m_ui_root(root)
+// whether a comes before b in a depth first walk of the tree
+bool ViewController::precedes_in_tree(View* a, View* b)
 {
-    dfs_insert(m_render_queue, root, min_int);
+    if (a->is_ancestor_of(b)) {
+        return true;
+    }
+    if (b->is_ancestor_of(a)) {
+        return false;
+    }
+    // climb b until its parent is an ancestor of a, then compare the two branches
+    View* b_branch = b;
+    View* parent = b->parent_view();
+    while (parent && !parent->is_ancestor_of(a)) {
+        b_branch = parent;
+        parent = parent->parent_view();
+    }
+    if (!parent) {
+        return false;
+    }
+    const size_t child_count = parent->get_child_count();
+    for (size_t i = 0; i < child_count; i++) {
+        View* child = parent->get_child(i);
+        if (child == b_branch) {
+            return false;
+        }
+        if (child->is_ancestor_of(a)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-ViewController::~ViewController()
+// runs[run] is the run the view joins unless its z index starts a new one
+void ViewController::collect_render_items(View* view, int parent_layer, std::vector<std::vector<RenderItem>>& runs, size_t run)
 {
-    delete m_ui_root;
+    bool layer_root = false;
+    if (view->get_z_index() > parent_layer) {
+        parent_layer = view->get_z_index();
+        runs.emplace_back();
+        run = runs.size() - 1;
+        layer_root = true;
+    }
+
+    const size_t index = runs[run].size();
+    runs[run].push_back({view, parent_layer, 1, layer_root});
+    const size_t child_count = view->get_child_count();
+    for (size_t i = 0; i < child_count; i++) {
+        collect_render_items(view->get_child(i), parent_layer, runs, run);
+    }
+    runs[run][index].subtree_size = static_cast<uint32_t>(runs[run].size() - index);
+}
+
+void ViewController::insert_render_items(View* view)
+{
+    View* parent = view->parent_view();
+    // run 0 continues the parent's layer, it stays empty if the view starts a layer itself
+    std::vector<std::vector<RenderItem>> runs(1);
+    collect_render_items(view, parent ? get_layer(parent) : min_int, runs, 0);
+
+    if (!runs[0].empty()) {
+        // goes into the parent's subtree, before the first item that comes after it in the tree
+        const size_t parent_index = find_render_item(parent);
+        const size_t parent_end = parent_index + m_render_list[parent_index].subtree_size;
+        size_t pos = parent_index + 1;
+        while (pos < parent_end && !precedes_in_tree(view, m_render_list[pos].view)) {
+            pos += m_render_list[pos].subtree_size;
+        }
+
+        const uint32_t count = static_cast<uint32_t>(runs[0].size());
+        for (size_t j = 0; j <= parent_index; j++) {
+            RenderItem& item = m_render_list[j];
+            if (item.z_index == runs[0][0].z_index && item.view->is_ancestor_of(parent)) {
+                item.subtree_size += count;
+            }
+        }
+        m_render_list.insert(m_render_list.begin() + pos, runs[0].begin(), runs[0].end());
+    }
+
+    for (size_t r = 1; r < runs.size(); r++) {
+        const RenderItem& root = runs[r][0];
+        size_t pos = 0;
+        while (pos < m_render_list.size()) {
+            const RenderItem& item = m_render_list[pos];
+            if (item.z_index > root.z_index || (item.z_index == root.z_index && item.layer_root && precedes_in_tree(root.view, item.view))) {
+                break;
+            }
+            pos++;
+        }
+        m_render_list.insert(m_render_list.begin() + pos, runs[r].begin(), runs[r].end());
+    }
+    m_hit_index_dirty = true;
+    m_view_under_pointer_valid = false;
+}
+
+void ViewController::remove_render_items(View* view)
+{
+    const size_t index = find_render_item(view);
+    if (index == m_render_list.size()) {
+        return;
+    }
+
+    const RenderItem removed = m_render_list[index];
+    if (!removed.layer_root) {
+        for (size_t j = 0; j < index; j++) {
+            RenderItem& item = m_render_list[j];
+            if (item.z_index == removed.z_index && item.view->is_ancestor_of(view)) {
+                item.subtree_size -= removed.subtree_size;
+            }
+        }
+    }
+    m_render_list.erase(m_render_list.begin() + index, m_render_list.begin() + index + removed.subtree_size);
+
+    // what is left of the subtree started layers of its own, those runs go as a whole
+    std::erase_if(m_render_list, [view](const RenderItem& item){ return view->is_ancestor_of(item.view); });
+    m_hit_index_dirty = true;
+    m_view_under_pointer_valid = false;
+}
+
+void ViewController::on_child_inserted(View* child)
+{
+    if (is_in_tree(child)) {
+        insert_render_items(child);
+        schedule_subtree_updates(child);
+    }
+}
+
+void ViewController::schedule_update(View* view)
+{
+    if (!view->m_update_requested) {
+        view->m_update_requested = true;
+        m_update_requests.push_back(view);
+    }
+}
+
+void ViewController::schedule_subtree_updates(View* view)
+{
+    schedule_update(view);
+    const size_t child_count = view->get_child_count();
+    for (size_t i = 0; i < child_count; i++) {
+        schedule_subtree_updates(view->get_child(i));
+    }
+}
+
+void ViewController::set_continuous_update(View* view, bool continuous)
+{
+    if (view->m_continuous_update == continuous) {
+        return;
+    }
+    view->m_continuous_update = continuous;
+    if (continuous) {
+        m_continuous_updates.push_back(view);
+    }
+    else {
+        std::erase(m_continuous_updates, view);
+    }
+}
+
+bool ViewController::has_scheduled_updates()
+{
+    for (View* view : m_update_requests) {
+        if (view->is_displayed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ViewController::run_updates()
+{
+    m_updating.clear();
+    std::swap(m_updating, m_update_requests);
+    // a continuous view with a pending request is in the list already
+    for (View* view : m_continuous_updates) {
+        if (!view->m_update_requested) {
+            m_updating.push_back(view);
+        }
+    }
+
+    for (View* view : m_updating) {
+        if (!view->is_displayed()) {
+            if (view->m_update_requested) {
+                m_update_requests.push_back(view);
+            }
+            continue;
+        }
+        // cleared first so on_update can ask for the next frame
+        view->m_update_requested = false;
+        view->update();
+    }
+}
+
+void ViewController::on_z_index_changed(View* view)
+{
+    if (is_in_tree(view)) {
+        remove_render_items(view);
+        insert_render_items(view);
+    }
+}
+
+void mark_new_layout(YGNodeRef node)
+{
+    YGNodeSetHasNewLayout(node, true);
+    const size_t child_count = YGNodeGetChildCount(node);
+    for (size_t i = 0; i < child_count; i++) {
+        YGNodeRef child = YGNodeGetChild(node, i);
+        if (YGNodeStyleGetDisplay(child) != YGDisplayNone) {
+            mark_new_layout(child);
+        }
+    }
 }
 
 void ViewController::update()
 {
-    update_input_state();
-    dispatch_events();
+    // each event is dispatched with the state it left behind, so a press and release within
+    // one frame is still a click and a drag hands over every point of its path
+    const std::vector<InputEvent>& input_events = m_input_queue.get_events();
+    if (input_events.empty()) {
+        // nothing happened, but what is under a still pointer may have changed
+        apply_input_event({.type = InputEvent::pointer_move, .pos = m_input_state.pointer_pos});
+        dispatch_events();
+    }
+    for (const InputEvent& input_event : input_events) {
+        apply_input_event(input_event);
+        dispatch_events();
+    }
+    m_input_queue.clear();
+    bool new_layout = false;
     if (m_ui_root->is_dirty() || m_resized)
     {
+        PROFILE_SCOPE(section_layout);
         m_ui_root->calc_layout(m_w, m_h);
         m_resized = false;
+        new_layout = true;
+        // the views get their new bounds in the update below, the next lookup rebuilds
+        m_hit_index_dirty = true;
+        m_view_under_pointer_valid = false;
     }
-    m_ui_root->update();
+    if (View::s_live_resizing && SDL_GetTicks() - m_last_resize_ticks >= resize_settle_delay)
+    {
+        // the size settled, every view gets on_resize again to rasterise at the final size
+        View::s_live_resizing = false;
+        mark_new_layout(m_ui_root->m_layout_node);
+        new_layout = true;
+    }
+    if (new_layout) {
+        m_ui_root->update_layout();
+    }
+    run_updates();
 }
 
-void render_dfs(View* root, int z_index) {
-    if (root->is_showing()) {
-        root->render();
-        size_t child_count = root->get_child_count();
-        for (size_t i = 0; i < child_count; ++i)
-        {
-            View* child = root->get_child(i);
-            if (child->get_z_index() <= z_index) {
-                render_dfs(child, z_index);
+void ViewController::render()
+{
+    render_items(0, m_render_list.size(), false);
+    m_ui_root->clear_redraw_requests();
+}
+
+// layers inside a layer that is being redrawn are drawn straight into it
+void ViewController::render_items(size_t begin, size_t end, bool into_layer)
+{
+    struct ClipState {
+        size_t end;             // the clip ends before this item
+        bool was_clipped;
+        SDL_Rect previous_clip;
+    };
+    std::vector<ClipState> clips;
+
+    auto restore_clip = [&](){
+        const ClipState& state = clips.back();
+        SDL_SetRenderClipRect(m_renderer, state.was_clipped ? &state.previous_clip : nullptr);
+        clips.pop_back();
+    };
+
+    size_t i = begin;
+    while (i < end)
+    {
+        while (!clips.empty() && clips.back().end <= i) {
+            restore_clip();
+        }
+
+        const RenderItem& item = m_render_list[i];
+        if (!item.view->is_showing()) {
+            i += item.subtree_size;
+            continue;
+        }
+
+        // clip the subtree, intersected with whatever an ancestor already clips to
+        const optional<SDL_FRect>& clip_rect = item.view->get_clip_rect();
+        if (clip_rect.has_value()) {
+            ClipState state = {i + item.subtree_size, SDL_RenderClipEnabled(m_renderer), {}};
+            SDL_Rect clip = rect_from_frect(clip_rect.value());
+            if (state.was_clipped) {
+                SDL_GetRenderClipRect(m_renderer, &state.previous_clip);
+                SDL_GetRectIntersection(&clip, &state.previous_clip, &clip);
             }
+            SDL_SetRenderClipRect(m_renderer, &clip);
+            clips.push_back(state);
+        }
+
+        if (item.view->m_cache_layer && !into_layer) {
+            render_layer(i);
+            i += item.subtree_size;
+            continue;
         }
+
+        item.view->render();
+        i++;
+    }
+    while (!clips.empty()) {
+        restore_clip();
     }
 }
 
-void ViewController::render()
+void ViewController::render_layer(size_t index)
 {
-    for (const auto &[z_index, render_queue] : m_render_queue)
-    {
-        for (auto &view : render_queue)
-        {
-            render_dfs(view, z_index);
+    const RenderItem& item = m_render_list[index];
+    View* view = item.view;
+    const SDL_FRect& bounds = view->m_bounds;
+    const int w = static_cast<int>(SDL_ceilf(bounds.w));
+    const int h = static_cast<int>(SDL_ceilf(bounds.h));
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    // a redraw request from anywhere in the subtree reached the view, or it was laid out again
+    bool dirty = view->m_needs_redraw;
+    if (!view->m_layer_texture || view->m_layer_texture->w < w || view->m_layer_texture->h < h) {
+        const int texture_w = view->m_layer_texture ? SDL_max(view->m_layer_texture->w, w) : w;
+        const int texture_h = view->m_layer_texture ? SDL_max(view->m_layer_texture->h, h) : h;
+        if (view->m_layer_texture) {
+            SDL_DestroyTexture(view->m_layer_texture);
         }
+        view->m_layer_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, texture_w, texture_h);
+        if (!view->m_layer_texture) {
+            SDL_Log("Couldn't create layer texture: %s", SDL_GetError());
+            render_items(index, index + item.subtree_size, true);
+            return;
+        }
+        // the subtree is blended onto a transparent texture, which leaves premultiplied colors
+        SDL_SetTextureBlendMode(view->m_layer_texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+        PROFILE_COUNT(counter_textures_created, 1);
+        dirty = true;
+    }
+
+    if (dirty) {
+        SDL_Texture* previous_target = SDL_GetRenderTarget(m_renderer);
+        SDL_SetRenderTarget(m_renderer, view->m_layer_texture);
+        // views draw in window coordinates, move the origin so the view lands at 0, 0
+        const SDL_Rect viewport = {-static_cast<int>(bounds.x), -static_cast<int>(bounds.y), static_cast<int>(bounds.x) + view->m_layer_texture->w, static_cast<int>(bounds.y) + view->m_layer_texture->h};
+        SDL_SetRenderViewport(m_renderer, &viewport);
+        SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
+        SDL_RenderClear(m_renderer);
+        render_items(index, index + item.subtree_size, true);
+        SDL_SetRenderTarget(m_renderer, previous_target);
     }
+
+    const SDL_FRect src = {0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)};
+    const SDL_FRect dst = {bounds.x, bounds.y, static_cast<float>(w), static_cast<float>(h)};
+    SDL_RenderTexture(m_renderer, view->m_layer_texture, &src, &dst);
+}
+
+bool ViewController::needs_redraw()
+{
+    return m_ui_root->needs_redraw();
 }
 
 void ViewController::resize(const int w, const int h)
 {
+    if (w == m_w && h == m_h) {
+        return;
+    }
+    // the very first layout has nothing to stretch
+    if (m_w != 0 || m_h != 0) {
+        View::s_live_resizing = true;
+        m_last_resize_ticks = SDL_GetTicks();
+    }
     m_w = w;
     m_h = h;
     m_resized = true;
 }
 
-View* ViewController::get_view_under_pointer(View* root, int z_index) {
+bool ViewController::is_live_resizing()
+{
+    return View::s_live_resizing;
+}
 
-    size_t child_count = root->get_child_count();
-    for (size_t i = 0; i < child_count; ++i)
-    {
-        View* child = root->get_child(i);
-        if (child->get_z_index() <= z_index) {
-            if (child->is_showing() && child->is_enabled() && child->contains_point(m_input_state.pointer_pos))
-            {
-                return get_view_under_pointer(child, z_index);
+void ViewController::push_event(SDL_Event event)
+{
+    // window to render coordinates, fingers from normalized ones
+    SDL_ConvertEventToRenderCoordinates(m_renderer, &event);
+    switch (event.type) {
+        case SDL_EVENT_MOUSE_MOTION:
+            // touches are handled below, the mouse events SDL makes up for them would double them
+            if (event.motion.which != SDL_TOUCH_MOUSEID) {
+                m_input_queue.push_pointer_move({event.motion.x, event.motion.y});
+            }
+            break;
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            if (event.button.which != SDL_TOUCH_MOUSEID) {
+                m_input_queue.push_pointer_button({event.button.x, event.button.y}, event.button.button, event.button.down);
+            }
+            break;
+        case SDL_EVENT_MOUSE_WHEEL:
+            m_input_queue.push_wheel({event.wheel.mouse_x, event.wheel.mouse_y}, event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y);
+            break;
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            m_input_queue.push_key(event.key.key, event.key.down, event.key.repeat);
+            break;
+        case SDL_EVENT_FINGER_DOWN:
+            if (!m_touch_active) {
+                m_touch_active = true;
+                m_touch_finger = event.tfinger.fingerID;
+                m_input_queue.push_pointer_button({event.tfinger.x, event.tfinger.y}, SDL_BUTTON_LEFT, true);
+            }
+            break;
+        case SDL_EVENT_FINGER_MOTION:
+            if (m_touch_active && event.tfinger.fingerID == m_touch_finger) {
+                m_input_queue.push_pointer_move({event.tfinger.x, event.tfinger.y});
             }
+            break;
+        case SDL_EVENT_FINGER_UP:
+        case SDL_EVENT_FINGER_CANCELED:
+            if (m_touch_active && event.tfinger.fingerID == m_touch_finger) {
+                m_touch_active = false;
+                m_input_queue.push_pointer_button({event.tfinger.x, event.tfinger.y}, SDL_BUTTON_LEFT, false);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void ViewController::set_scripted_pointer(SDL_FPoint pos, bool mouse_down)
+{
+    if (mouse_down != m_input_queue.is_button_down(SDL_BUTTON_LEFT)) {
+        m_input_queue.push_pointer_button(pos, SDL_BUTTON_LEFT, mouse_down);
+    }
+    else {
+        m_input_queue.push_pointer_move(pos);
+    }
+}
+
+void ViewController::invalidate_hit_test()
+{
+    m_view_under_pointer_valid = false;
+}
+
+void ViewController::build_hit_index()
+{
+    m_hit_cols = (m_w + hit_cell_size - 1) / hit_cell_size;
+    m_hit_rows = (m_h + hit_cell_size - 1) / hit_cell_size;
+    // the cells keep their capacity, a relayout mostly puts back the same number of views
+    m_hit_cells.resize(m_hit_cols * m_hit_rows);
+    for (auto& cell : m_hit_cells) {
+        cell.clear();
+    }
+
+    for (size_t i = 0; i < m_render_list.size(); i++) {
+        View* view = m_render_list[i].view;
+        const SDL_FRect& bounds = view->m_bounds;
+        // hidden views aren't laid out, showing them again relayouts and rebuilds the index
+        if (!view->is_showing() || bounds.w <= 0 || bounds.h <= 0) {
+            continue;
+        }
+        if (bounds.x >= m_w || bounds.y >= m_h || bounds.x + bounds.w <= 0 || bounds.y + bounds.h <= 0) {
+            continue;
+        }
+        const int first_col = SDL_max(0, static_cast<int>(bounds.x) / hit_cell_size);
+        const int first_row = SDL_max(0, static_cast<int>(bounds.y) / hit_cell_size);
+        const int last_col = SDL_min(m_hit_cols - 1, static_cast<int>(bounds.x + bounds.w) / hit_cell_size);
+        const int last_row = SDL_min(m_hit_rows - 1, static_cast<int>(bounds.y + bounds.h) / hit_cell_size);
+        for (int row = first_row; row <= last_row; row++) {
+            for (int col = first_col; col <= last_col; col++) {
+                m_hit_cells[row * m_hit_cols + col].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+    m_hit_index_dirty = false;
+}
+
+View* ViewController::find_view_at(const SDL_FPoint& point)
+{
+    if (point.x < 0 || point.y < 0) {
+        return nullptr;
+    }
+    const int col = static_cast<int>(point.x) / hit_cell_size;
+    const int row = static_cast<int>(point.y) / hit_cell_size;
+    if (col >= m_hit_cols || row >= m_hit_rows) {
+        return nullptr;
+    }
+    const std::vector<uint32_t>& candidates = m_hit_cells[row * m_hit_cols + col];
+
+    auto is_hit = [&](View* view) {
+        return view->is_showing() && view->is_enabled() && view->contains_point(point);
+    };
+
+    // the topmost layer root under the point
+    size_t k = candidates.size();
+    size_t current = m_render_list.size();
+    while (k > 0) {
+        k--;
+        const RenderItem& item = m_render_list[candidates[k]];
+        if (item.layer_root && is_hit(item.view)) {
+            current = candidates[k];
+            break;
         }
     }
+    if (current == m_render_list.size()) {
+        return nullptr;
+    }
 
-    return root;
+    // then down its subtree, into the first child under the point at each level. a view
+    // that isn't in this cell can't be under the point, neither can anything below it
+    size_t end = current + m_render_list[current].subtree_size;
+    size_t skip_until = 0;
+    for (k = k + 1; k < candidates.size() && candidates[k] < end; k++) {
+        const size_t index = candidates[k];
+        const RenderItem& item = m_render_list[index];
+        if (index < skip_until || item.view->parent_view() != m_render_list[current].view) {
+            continue;
+        }
+        if (is_hit(item.view)) {
+            current = index;
+            end = index + item.subtree_size;
+        }
+        else {
+            skip_until = index + item.subtree_size;
+        }
+    }
+    return m_render_list[current].view;
 }
 
 View* ViewController::get_view_under_pointer() {
-    for (auto z_iter = m_render_queue.rbegin(); z_iter != m_render_queue.rend(); ++z_iter)
-    {
-        auto &[z_index, render_queue] = *z_iter;
-        for (auto view_iter = render_queue.rbegin(); view_iter != render_queue.rend(); ++view_iter)
-        {
-            View* view = *view_iter;
-            if (view->is_showing() && view->is_enabled() && view->contains_point(m_input_state.pointer_pos))
-            {
-                return get_view_under_pointer(view, z_index);
-            }
+    // nothing moved since the last lookup
+    if (m_view_under_pointer_valid && POINTS_EQUAL(m_input_state.pointer_pos, m_input_state.prev_pointer_pos)) {
+        if (!m_view_under_pointer || m_view_under_pointer->is_enabled()) {
+            return m_view_under_pointer;
         }
     }
 
-    return nullptr;
+    if (m_hit_index_dirty) {
+        build_hit_index();
+    }
+    m_view_under_pointer = find_view_at(m_input_state.pointer_pos);
+    m_view_under_pointer_valid = true;
+    return m_view_under_pointer;
 }
 
 void ViewController::update_current_entered_stack(View* current_target) {
@@ -150,8 +639,6 @@ void ViewController::update_current_entered_stack(View* current_target) {
     }
 }
 
-#define POINTS_EQUAL(p1,p2) ((p1.x == p2.x) && (p1.y == p2.y))
-
 void ViewController::dispatch_events_to_target(View* target) {
 
     if (m_input_state.mouse_is_pressed_down_this_frame) {
@@ -192,6 +679,29 @@ void ViewController::dispatch_events_to_target(View* target) {
             }
         }
     }
+
+    if (m_input_state.wheel_delta != 0.0f) {
+        View* wheel_target = target;
+        Event event(Event::mouse_wheel, &m_input_state);
+        while(!wheel_target->handle_event(event)) {
+            wheel_target = wheel_target->parent_view();
+            if (!wheel_target) {
+                break;
+            }
+        }
+    }
+
+    // there is no keyboard focus, keys go where the pointer is
+    if (m_input_state.key != 0) {
+        View* key_target = target;
+        Event event(m_input_state.key_is_down ? Event::key_down : Event::key_up, &m_input_state);
+        while(!key_target->handle_event(event)) {
+            key_target = key_target->parent_view();
+            if (!key_target) {
+                break;
+            }
+        }
+    }
 }
 
 void ViewController::dispatch_events()
@@ -210,16 +720,47 @@ void ViewController::dispatch_events()
     }
 }
 
-void ViewController::update_input_state()
+void ViewController::apply_input_event(const InputEvent& input_event)
 {
-    const InputState prev_input_state = m_input_state;
-    InputState& current_input_state = m_input_state;
-    SDL_FPoint pointer_window_pos;
-    SDL_MouseButtonFlags mouse_state = SDL_GetMouseState(&pointer_window_pos.x, &pointer_window_pos.y);
-    // convert from window cords to pixle cords
-    SDL_RenderCoordinatesFromWindow(m_renderer, pointer_window_pos.x, pointer_window_pos.y, &current_input_state.pointer_pos.x, &current_input_state.pointer_pos.y);
-    current_input_state.prev_pointer_pos = prev_input_state.pointer_pos;
-    current_input_state.mouse_is_down = mouse_state & SDL_BUTTON_LMASK;
-    current_input_state.mouse_is_pressed_down_this_frame = !prev_input_state.mouse_is_down && current_input_state.mouse_is_down;
-    current_input_state.mouse_is_released_up_this_frame = prev_input_state.mouse_is_down && !current_input_state.mouse_is_down;
-}
\ No newline at end of file
+    InputState& state = m_input_state;
+    // the edges only last for the event that caused them
+    state.prev_pointer_pos = state.pointer_pos;
+    state.mouse_is_pressed_down_this_frame = false;
+    state.mouse_is_released_up_this_frame = false;
+    state.wheel_delta = 0.0f;
+    state.key = 0;
+    state.key_is_down = false;
+    state.key_repeat = false;
+
+    switch (input_event.type) {
+        case InputEvent::pointer_move:
+            state.pointer_pos = input_event.pos;
+            break;
+        case InputEvent::pointer_down:
+        case InputEvent::pointer_up: {
+            const bool down = input_event.type == InputEvent::pointer_down;
+            state.pointer_pos = input_event.pos;
+            if (input_event.button == SDL_BUTTON_LEFT) {
+                state.mouse_is_pressed_down_this_frame = down && !state.mouse_is_down;
+                state.mouse_is_released_up_this_frame = !down && state.mouse_is_down;
+                state.mouse_is_down = down;
+            }
+            else if (input_event.button == SDL_BUTTON_RIGHT || input_event.button == SDL_BUTTON_MIDDLE) {
+                const uint32_t mask = SDL_BUTTON_MASK(input_event.button);
+                m_pan_buttons = down ? m_pan_buttons | mask : m_pan_buttons & ~mask;
+                state.pan_is_down = m_pan_buttons != 0;
+            }
+            break;
+        }
+        case InputEvent::wheel:
+            state.pointer_pos = input_event.pos;
+            state.wheel_delta = input_event.wheel_delta;
+            break;
+        case InputEvent::key_down:
+        case InputEvent::key_up:
+            state.key = input_event.key;
+            state.key_is_down = input_event.type == InputEvent::key_down;
+            state.key_repeat = input_event.repeat;
+            break;
+    }
+}
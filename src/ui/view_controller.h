@@ -1,10 +1,11 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
 #include <vector>
 
 #include "view.h"
 #include "../input.h"
+#include "../events/input_queue.h"
 
 class ViewController 
 {
@@ -15,25 +16,97 @@ public:
     void update();
     void render();
     void resize(const int w, const int h);
+    bool needs_redraw();
+
+    // a resize is laid out right away but views stretch what they have until the size
+    // stopped changing for this long, then everything gets laid out at full quality again
+    static constexpr uint64_t resize_settle_delay = 150;
+    bool is_live_resizing();
+
+    // queues the mouse, wheel, keyboard and touch events of the frame, they are applied
+    // and dispatched one by one in the next update. other events are ignored
+    void push_event(SDL_Event event);
+    // headless runs drive the pointer from a script instead of the mouse
+    void set_scripted_pointer(SDL_FPoint pos, bool mouse_down);
+
+    // keep the render list in step with the tree, called by View
+    void on_child_inserted(View* child);
+    void on_z_index_changed(View* view);
+    // the view under a still pointer may have changed, e.g. something was shown or hidden
+    void invalidate_hit_test();
+
+    // on_update scheduling, called by View
+    void schedule_update(View* view);
+    void set_continuous_update(View* view, bool continuous);
+    // one shot updates of showing views are waiting, the loop shouldn't sleep
+    bool has_scheduled_updates();
     
 private:
     View* m_ui_root;
     SDL_Renderer* m_renderer;
-    int m_w;
-    int m_h;
+    int m_w = 0;
+    int m_h = 0;
     bool m_resized = false;
+    uint64_t m_last_resize_ticks = 0;
+    InputQueue m_input_queue;
+    // the first finger down acts as the left button until it is lifted, others are ignored
+    bool m_touch_active = false;
+    SDL_FingerID m_touch_finger = 0;
+    // right and middle both pan, it lasts until the last of them is released
+    uint32_t m_pan_buttons = 0;
     bool m_captured = false;
     View* m_capturing_view = nullptr;
-    std::map<int, std::vector<View*>> m_render_queue;
+
+    struct RenderItem {
+        View* view;
+        int z_index;            // the layer it is drawn in, the highest z index on its path
+        uint32_t subtree_size;  // itself and the items after it that belong to its subtree in this layer
+        bool layer_root;        // its z index lifted it above its parent's layer
+    };
+    // every view in draw order: by layer, then in tree order. rendering is one pass over it,
+    // a hidden view skips its subtree and a clip rect covers the next subtree_size items
+    std::vector<RenderItem> m_render_list;
+
+    // hit testing: for each cell of a uniform grid over the window, the render list indices
+    // of the showing views overlapping it, ascending. rebuilt on the first lookup after the
+    // layout or the render list changed
+    static constexpr int hit_cell_size = 64;
+    std::vector<std::vector<uint32_t>> m_hit_cells;
+    int m_hit_cols = 0;
+    int m_hit_rows = 0;
+    bool m_hit_index_dirty = true;
+    // views that asked for one on_update, in request order. requests made during the update
+    // pass are served next frame, requests of hidden views wait until they are shown
+    std::vector<View*> m_update_requests;
+    std::vector<View*> m_continuous_updates;
+    std::vector<View*> m_updating;
+
+    // the last lookup, reused while neither the pointer nor the views moved
+    View* m_view_under_pointer = nullptr;
+    bool m_view_under_pointer_valid = false;
     
     InputState m_input_state;
     std::vector<View*> m_current_entered_stack;
     
-    void update_input_state();
+    void apply_input_event(const InputEvent& input_event);
     View* get_view_under_pointer();
     void update_current_entered_stack(View* current_target);
     void dispatch_events_to_target(View *target);
     void dispatch_events();
 
-    View* get_view_under_pointer(View *root, int z_index);
+    void render_items(size_t begin, size_t end, bool into_layer);
+    void render_layer(size_t index);
+
+    void build_hit_index();
+    View* find_view_at(const SDL_FPoint& point);
+
+    bool is_in_tree(View* view);
+    static int get_layer(View* view);
+    static bool precedes_in_tree(View* a, View* b);
+    size_t find_render_item(View* view);
+    void collect_render_items(View* view, int parent_layer, std::vector<std::vector<RenderItem>>& runs, size_t run);
+    void insert_render_items(View* view);
+    void schedule_subtree_updates(View* view);
+    void run_updates();
+    void remove_render_items(View* view);
 };
\ No newline at end of file
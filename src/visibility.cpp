@@ -0,0 +1,106 @@
+#include <bit>
+#include <vector>
+#include <algorithm>
+#include "visibility.h"
+
+void compute_visibility_map(Cells<CellState>& cell_state, Cells<int32_t>& visibility)
+{
+    const size_t size = cell_state.m_size;
+    const size_t words_per_row = (size + 63) / 64;
+
+    // scratch buffers are reused between calls, one set per generator thread
+    thread_local std::vector<uint8_t> in_bag;
+    thread_local std::vector<int32_t> column_run;   // bag cells above and including, per column
+    thread_local std::vector<int32_t> carry;
+    thread_local std::vector<uint64_t> bitboard;
+    in_bag.resize(size * size);
+    column_run.resize((size + 1) * size);
+    carry.resize(size);
+    bitboard.resize(words_per_row);
+
+    // row -1 of the running counts is all zeros so the first row needs no special case
+    std::fill(column_run.begin(), column_run.begin() + size, 0);
+
+    // rows, top to bottom
+    for (size_t i = 0; i < size; i++)
+    {
+        const CellState* states = &cell_state.at(i, 0);
+        uint8_t* in = &in_bag[i * size];
+        const int32_t* run_above = &column_run[i * size];
+        int32_t* run = &column_run[(i + 1) * size];
+        int32_t* row_visibility = &visibility.at(i, 0);
+
+        for (size_t word = 0; word < words_per_row; word++)
+        {
+            const size_t begin = word * 64;
+            const size_t end = std::min(size, begin + 64);
+            uint64_t bits = 0;
+            for (size_t j = begin; j < end; j++)
+            {
+                const uint8_t cell_in = states[j] == CellState::in_bag;
+                in[j] = cell_in;
+                run[j] = cell_in * (run_above[j] + 1);
+                bits |= static_cast<uint64_t>(cell_in) << (j - begin);
+            }
+            bitboard[word] = bits;
+        }
+
+        // jump from run to run on the bitboard, every run is filled with its length
+        size_t j = 0;
+        while (j < size)
+        {
+            size_t start = j;
+            while (start < size)
+            {
+                const uint64_t ones = bitboard[start / 64] >> (start % 64);
+                if (ones)
+                {
+                    start += std::countr_zero(ones);
+                    break;
+                }
+                start = (start / 64 + 1) * 64;
+            }
+            start = std::min(start, size);
+            std::fill(row_visibility + j, row_visibility + start, 0);
+            if (start == size)
+            {
+                break;
+            }
+
+            size_t end = start;
+            while (end < size)
+            {
+                const size_t offset = end % 64;
+                const size_t step = std::countr_one(bitboard[end / 64] >> offset);
+                end += std::min(step, 64 - offset);
+                // the run only goes on if it filled the word to its last bit
+                if (step < 64 - offset)
+                {
+                    break;
+                }
+            }
+            end = std::min(end, size);
+            std::fill(row_visibility + start, row_visibility + end, static_cast<int32_t>(end - start));
+            j = end;
+        }
+    }
+
+    // columns, bottom to top. a run's length is the running count at its lowest cell,
+    // carry it up while the cell below is in the bag
+    std::fill(carry.begin(), carry.end(), 0);
+    for (size_t i = size; i-- > 0;)
+    {
+        const uint8_t* in = &in_bag[i * size];
+        const uint8_t* in_below = &in_bag[std::min(i + 1, size - 1) * size];
+        const int32_t below_valid = i + 1 < size;
+        const int32_t* run = &column_run[(i + 1) * size];
+        int32_t* row_visibility = &visibility.at(i, 0);
+
+        for (size_t j = 0; j < size; j++)
+        {
+            const int32_t keep = in_below[j] & below_valid;
+            carry[j] = in[j] * (keep ? carry[j] : run[j]);
+            row_visibility[j] += carry[j] - in[j];
+        }
+    }
+}
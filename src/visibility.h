@@ -0,0 +1,11 @@
+#pragma once
+
+#include "puzzle.h"
+
+// number of bag cells visible from every cell (itself included) looking along its row and
+// column, 0 for cells outside the bag. this is the clue value a cell would get.
+//
+// two passes: the first one finds the row runs on a bitboard of the row and builds the
+// running column counts, the second one walks up and spreads the length of every column
+// run over it. both inner loops over a row are branch free so they vectorize.
+void compute_visibility_map(Cells<CellState>& cell_state, Cells<int32_t>& visibility);
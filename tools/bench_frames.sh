@@ -0,0 +1,34 @@
+#!/bin/sh
+# frame times of headless builds on boards of several sizes
+#
+# usage: tools/bench_frames.sh path/to/corral [path/to/baseline/corral] [frames]
+#
+# the pointer sweeps over the board every frame so every frame is drawn. a second build,
+# e.g. of an older commit, runs the same sizes for comparison.
+# then 10 s of the normal event loop without input, rendering on demand and with
+# --redraw-every-frame, reporting the process cpu time.
+
+bin=${1:-./build/corral}
+baseline=$2
+frames=${3:-600}
+script=$(mktemp)
+trap 'rm -f "$script"' EXIT
+
+awk -v frames="$frames" 'BEGIN {
+    for (f = 0; f < frames; f++) {
+        printf "%d move %d %d\n", f, 150 + (f * 7) % 700, 300 + (f * 3) % 400
+    }
+}' > "$script"
+
+for size in 10 50 200; do
+    echo "${size}x${size}: $("$bin" --headless 1000x1000 --seed 480000 --frames "$frames" --script "$script" --board "$size" | tail -n 1)"
+    if [ -n "$baseline" ]; then
+        echo "${size}x${size} baseline: $("$baseline" --headless 1000x1000 --seed 480000 --frames "$frames" --script "$script" --board "$size" | tail -n 1)"
+    fi
+done
+
+# idle cpu: the real event loop with its sleeps for a fixed wall clock window, nothing moves
+idle=$("$bin" --headless 1000x1000 --seed 480000 --idle-seconds 10 | tail -n 1)
+idle_redraw=$("$bin" --headless 1000x1000 --seed 480000 --idle-seconds 10 --redraw-every-frame | tail -n 1)
+echo "idle on demand:   $idle"
+echo "idle every frame: $idle_redraw"
@@ -0,0 +1,109 @@
+// picks the featured puzzle of the day out of k candidates generated in parallel
+//
+// usage: featured_puzzle [--size n] [--day d] [--k n] [--accept score] [--mode edge|frontier|mcmc] [--chains n] [--threads n]
+//
+// prints the throughput and score distribution, then the winner in the puzzle_cache line
+// format with the day in place of the hour. only a unique puzzle can win, the candidate seed
+// the winner was generated from is printed on the line before
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+
+#include "puzzle.h"
+#include "puzzle_quality.h"
+#include "random.h"
+#include "thread_pool.h"
+
+struct FeaturedOptions {
+    size_t size = 10;
+    uint64_t day = Random::get_hourly_seed() / 24;
+    size_t threads = std::thread::hardware_concurrency();
+    BestOfKConfig config;
+};
+
+static void print_usage(const char* program)
+{
+    std::fprintf(stderr, "usage: %s [--size n] [--day d] [--k n] [--accept score] [--mode edge|frontier|mcmc] [--chains n] [--threads n]\n", program);
+}
+
+static bool parse_options(int argc, char** argv, FeaturedOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--size") == 0 && has_value) {
+            options.size = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--day") == 0 && has_value) {
+            options.day = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--k") == 0 && has_value) {
+            options.config.k = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--accept") == 0 && has_value) {
+            options.config.accept_score = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(arg, "--mode") == 0 && has_value) {
+            const char* mode = argv[++i];
+            if (std::strcmp(mode, "edge") == 0) {
+                options.config.mode = GenerationMode::edge_peeling;
+            }
+            else if (std::strcmp(mode, "frontier") == 0) {
+                options.config.mode = GenerationMode::frontier;
+            }
+            else if (std::strcmp(mode, "mcmc") == 0) {
+                options.config.mode = GenerationMode::mcmc;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--chains") == 0 && has_value) {
+            options.config.mcmc_chains = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            return false;
+        }
+    }
+    return options.size > 0 && options.config.k > 0;
+}
+
+int main(int argc, char** argv)
+{
+    FeaturedOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(options.threads);
+    BestOfKReport report = generate_best_puzzle(options.size, options.day, options.config, pool);
+
+    std::printf("candidates: %zu scored, %zu cancelled, %zu unique\n", report.candidates_scored, report.candidates_cancelled, report.unique_candidates);
+    std::printf("throughput: %.1f candidates/s on %zu threads (%.3f s)\n", report.candidates_per_second, pool.get_thread_count(), report.elapsed_seconds);
+    std::printf("scores: min %.3f mean %.3f max %.3f\n", report.min_score, report.mean_score, report.max_score);
+    for (size_t bucket = 0; bucket < report.score_histogram.size(); bucket++) {
+        std::printf("  [%.1f, %.1f) %zu\n", bucket / 10.0, (bucket + 1) / 10.0, report.score_histogram[bucket]);
+    }
+
+    if (!report.best) {
+        std::fprintf(stderr, "no unique candidate among %zu scored\n", report.candidates_scored);
+        return EXIT_FAILURE;
+    }
+
+    const PuzzleScore& score = report.best_score;
+    std::printf("best: candidate %zu, seed %" PRIu64 ", score %.3f, %zu clues, grade %u, compactness %.2f\n",
+        report.best_index, report.best->m_seed, score.total, score.clue_count, score.difficulty_grade, score.compactness);
+
+    std::printf("%" PRIu64 " %zu %016" PRIx64, options.day, options.size, report.best->get_fingerprint());
+    for (auto& [pos, target] : report.best->get_targets()) {
+        std::printf(" %d,%d,%d", pos.i, pos.j, target);
+    }
+    std::printf("\n");
+    return EXIT_SUCCESS;
+}
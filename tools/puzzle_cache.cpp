@@ -0,0 +1,144 @@
+// precomputes the hourly puzzles for a window of hours into a cache file
+//
+// usage: puzzle_cache [-o file] [--start hour] [--hours n] [--sizes 4,6,10] [--mode edge|frontier|mcmc] [--threads n]
+//
+// every line of the output is "<hour> <size> <fingerprint> <i>,<j>,<target> ..."
+// so a client can compare the puzzle it generated with the cached one.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+#include "random.h"
+#include "thread_pool.h"
+
+struct CacheOptions {
+    const char* output_path = "puzzle_cache.txt";
+    uint64_t start_hour = Random::get_hourly_seed();
+    size_t hours = 24;
+    std::vector<size_t> sizes = {4, 6, 10};
+    GenerationMode mode = GenerationMode::edge_peeling;
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+struct CacheEntry {
+    uint64_t hour;
+    size_t size;
+    uint64_t fingerprint;
+    std::vector<CellTarget> targets;
+};
+
+static void print_usage(const char* program)
+{
+    std::fprintf(stderr, "usage: %s [-o file] [--start hour] [--hours n] [--sizes 4,6,10] [--mode edge|frontier|mcmc] [--threads n]\n", program);
+}
+
+static std::vector<size_t> parse_sizes(const char* list)
+{
+    std::vector<size_t> sizes;
+    const char* iter = list;
+    while (*iter) {
+        char* end;
+        size_t size = std::strtoull(iter, &end, 10);
+        if (end == iter) {
+            break;
+        }
+        if (size > 0) {
+            sizes.push_back(size);
+        }
+        iter = (*end == ',') ? end + 1 : end;
+    }
+    return sizes;
+}
+
+static bool parse_options(int argc, char** argv, CacheOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "-o") == 0 && has_value) {
+            options.output_path = argv[++i];
+        }
+        else if (std::strcmp(arg, "--start") == 0 && has_value) {
+            options.start_hour = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--hours") == 0 && has_value) {
+            options.hours = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--sizes") == 0 && has_value) {
+            options.sizes = parse_sizes(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--mode") == 0 && has_value) {
+            const char* mode = argv[++i];
+            if (std::strcmp(mode, "edge") == 0) {
+                options.mode = GenerationMode::edge_peeling;
+            }
+            else if (std::strcmp(mode, "frontier") == 0) {
+                options.mode = GenerationMode::frontier;
+            }
+            else if (std::strcmp(mode, "mcmc") == 0) {
+                options.mode = GenerationMode::mcmc;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.sizes.empty();
+}
+
+int main(int argc, char** argv)
+{
+    CacheOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // one slot per (hour, size) so the file comes out in the same order regardless of scheduling
+    std::vector<CacheEntry> entries(options.hours * options.sizes.size());
+    {
+        ThreadPool pool(options.threads);
+        for (size_t h = 0; h < options.hours; h++) {
+            for (size_t s = 0; s < options.sizes.size(); s++) {
+                CacheEntry* entry = &entries[h * options.sizes.size() + s];
+                entry->hour = options.start_hour + h;
+                entry->size = options.sizes[s];
+                pool.submit([entry, mode = options.mode]{
+                    auto puzzle = Puzzle::generate_puzzle(entry->size, entry->hour, mode);
+                    entry->fingerprint = puzzle->get_fingerprint();
+                    entry->targets = puzzle->get_targets();
+                });
+            }
+        }
+        pool.wait();
+    }
+
+    FILE* file = std::fopen(options.output_path, "w");
+    if (!file) {
+        std::fprintf(stderr, "couldn't open %s for writing\n", options.output_path);
+        return EXIT_FAILURE;
+    }
+
+    for (auto& entry : entries) {
+        std::fprintf(file, "%" PRIu64 " %zu %016" PRIx64, entry.hour, entry.size, entry.fingerprint);
+        for (auto& [pos, target] : entry.targets) {
+            std::fprintf(file, " %d,%d,%d", pos.i, pos.j, target);
+        }
+        std::fputc('\n', file);
+    }
+    std::fclose(file);
+
+    std::printf("wrote %zu puzzles to %s\n", entries.size(), options.output_path);
+    return EXIT_SUCCESS;
+}